@@ -11,6 +11,8 @@
 #include "common/Paths.h"
 #include "common/Utils.h" // compute_std
 #include "results/Result.h"
+#include "results/ResultsCatalog.h"
+#include "results/ResultFile.hpp"
 #include "BestResultsExcel.h"
 #include "BestResultsTex.h"
 #include "BestResultsMd.h"
@@ -42,8 +44,7 @@ namespace platform {
         }
         json bests;
         for (const auto& file : files) {
-            auto result = Result(path, file);
-            auto data = result.getJson();
+            auto data = getSummary(file).getData();
             for (auto const& item : data.at("results")) {
                 bool update = true;
                 auto datasetName = item.at("dataset").get<std::string>();
@@ -87,7 +88,7 @@ namespace platform {
         std::string fileModel, fileScore;
         for (const auto& file : directory_iterator(path)) {
             auto fileName = file.path().filename().string();
-            if (fileName.find(".json") != std::string::npos && fileName.find("results_") == 0) {
+            if (ResultFile::isResultFile(fileName)) {
                 tie(fileModel, fileScore) = getModelScore(fileName);
                 if (score == fileScore && (model == fileModel || model == "any")) {
                     files.push_back(fileName);
@@ -97,6 +98,16 @@ namespace platform {
         std::sort(files.begin(), files.end());
         return files;
     }
+    const Result& BestResults::getSummary(const std::string& fileName)
+    {
+        // Only the per dataset scores are needed, they are taken from the results catalog
+        if (summaries.empty()) {
+            for (auto& result : ResultsCatalog(path).load()) {
+                summaries.emplace(result.getFilename(), std::move(result));
+            }
+        }
+        return summaries.at(fileName);
+    }
     json BestResults::loadFile(const std::string& fileName)
     {
         std::ifstream resultData(fileName);
@@ -148,7 +159,7 @@ namespace platform {
     }
     std::vector<std::string> BestResults::getAllDatasets(json table)
     {
-        auto allDatasets = Datasets(false, Paths::datasets());
+        auto& allDatasets = Datasets::shared(false, Paths::datasets());
         auto datasets = allDatasets.getNames();
         if (!datasets.empty()) {
             maxDatasetName = (*max_element(datasets.begin(), datasets.end(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); })).size();
@@ -1,7 +1,9 @@
 #ifndef BESTRESULTS_H
 #define BESTRESULTS_H
+#include <map>
 #include <string>
 #include <nlohmann/json.hpp>
+#include "results/Result.h"
 namespace platform {
     using json = nlohmann::ordered_json;
 
@@ -21,6 +23,7 @@ namespace platform {
         std::vector<std::string> getDatasets(json table);
         std::vector<std::string> getAllDatasets(json table);
         std::vector<std::string> loadResultFiles();
+        const Result& getSummary(const std::string& fileName);
         void messageOutputFile(const std::string& title, const std::string& fileName);
         json buildTableResults(std::vector<std::string> models);
         void printTableResults(std::vector<std::string> models, json table, bool tex, bool index);
@@ -36,6 +39,7 @@ namespace platform {
         int maxDatasetName = 0;
         int minLength = 13; // Minimum length for scores
         std::string excelFileName;
+        std::map<std::string, Result> summaries; // Results catalog, loaded once and shared by every model
     };
 }
 #endif
\ No newline at end of file
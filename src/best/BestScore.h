@@ -15,12 +15,12 @@ namespace platform {
             };
             auto env = platform::DotEnv();
             std::string experiment = env.get("experiment");
-            try {
-                return data[{experiment, metric}];
-            }
-            catch (...) {
+            // Lookup without inserting, the results are parsed from several threads
+            auto it = data.find({ experiment, metric });
+            if (it == data.end()) {
                 return { "", 0.0 };
             }
+            return it->second;
         }
     };
 }
@@ -60,6 +60,7 @@ void add_search_args(argparse::ArgumentParser& program)
         catch (...) {
             throw std::runtime_error("Number of nested folds must be an integer");
         }});
+        program.add_argument("--granularity").help("Unit of work sent to the workers: fold, combination or nested (combination and nested fold)").default_value("fold").choices("fold", "combination", "nested");
         program.add_argument("--score").help("Score used in gridsearch").default_value("accuracy");
         program.add_argument("-f", "--folds").help("Number of folds").default_value(stoi(env.get("n_folds"))).scan<'i', int>().action([](const std::string& value) {
             try {
@@ -201,6 +202,7 @@ void search(argparse::ArgumentParser& program)
     config.only = program.get<bool>("only");
     config.seeds = program.get<std::vector<int>>("seeds");
     config.nested = program.get<int>("nested");
+    config.granularity = program.get<std::string>("granularity");
     config.continue_from = program.get<std::string>("continue");
     if (config.continue_from == platform::GridSearch::NO_CONTINUE() && config.only) {
         throw std::runtime_error("Cannot use --only without --continue");
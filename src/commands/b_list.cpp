@@ -70,12 +70,12 @@ int main(int argc, char** argv)
     //
     argparse::ArgumentParser results_command("results");
     results_command.add_description("List the results of a given dataset.");
-    auto datasets = platform::Datasets(false, platform::Paths::datasets());
+    auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
     results_command.add_argument("-d", "--dataset")
         .help("Dataset to use " + datasets.toString())
         .required()
         .action([](const std::string& value) {
-        auto datasets = platform::Datasets(false, platform::Paths::datasets());
+        auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
         static const std::vector<std::string> choices = datasets.getNames();
         if (find(choices.begin(), choices.end(), value) != choices.end()) {
             return value;
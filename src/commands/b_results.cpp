@@ -7,6 +7,7 @@
 #include "common/Paths.h"
 #include "results/JsonValidator.h"
 #include "results/SchemaV1_0.h"
+#include "results/ResultFile.hpp"
 #include "config_platform.h"
 
 using json = nlohmann::json;
@@ -23,14 +24,29 @@ int main(int argc, char* argv[])
     program.add_description("Check the results files and optionally fixes them.");
     program.add_argument("--fix").help("Fix any errors in results").default_value(false).implicit_value(true);
     program.add_argument("--file").help("check only this results file").default_value("");
-    std::string nameSuffix = "results_";
+    argparse::ArgumentParser convert_command("convert");
+    convert_command.add_description("Convert the results files between JSON and the binary (CBOR) format.");
+    convert_command.add_argument("--to").help("Target format: json or cbor").default_value(std::string{ "cbor" })
+        .action([](const std::string& value) {
+        if (value == "json" || value == "cbor") {
+            return value;
+        }
+        throw std::runtime_error("Format must be one of: json, cbor");
+            }
+        );
+    convert_command.add_argument("--file").help("convert only this results file").default_value("");
+    program.add_subparser(convert_command);
     std::string schemaVersion = "1.0";
     bool fix_it = false;
     std::string selected_file;
     try {
         program.parse_args(argc, argv);
-        fix_it = program.get<bool>("fix");
-        selected_file = program.get<std::string>("file");
+        if (program.is_subcommand_used("convert")) {
+            selected_file = convert_command.get<std::string>("file");
+        } else {
+            fix_it = program.get<bool>("fix");
+            selected_file = program.get<std::string>("file");
+        }
     }
     catch (const std::exception& err) {
         std::cerr << err.what() << std::endl;
@@ -52,7 +68,7 @@ int main(int argc, char* argv[])
     } else {
         // Load the result files and find the longest file name
         for (const auto& entry : fs::directory_iterator(platform::Paths::results())) {
-            if (entry.is_regular_file() && entry.path().filename().string().starts_with(nameSuffix) && entry.path().filename().string().ends_with(".json")) {
+            if (entry.is_regular_file() && platform::ResultFile::isResultFile(entry.path().string())) {
                 std::string fileName = entry.path().string();
                 if (fileName.length() > max_length) {
                     max_length = fileName.length();
@@ -68,6 +84,23 @@ int main(int argc, char* argv[])
         std::cerr << "Error: No result files found." << std::endl;
         return 1;
     }
+    if (program.is_subcommand_used("convert")) {
+        //
+        // Convert the results files
+        //
+        auto format = convert_command.get<std::string>("to");
+        int converted = 0;
+        for (const auto& file_name : result_files) {
+            if (file_name.ends_with("." + format)) {
+                continue;
+            }
+            auto target = platform::ResultFile::convert(file_name, format);
+            std::cout << file_name << " -> " << target << std::endl;
+            converted++;
+        }
+        header(std::to_string(converted) + " files converted to " + format + ".", max_length, "*");
+        return 0;
+    }
     std::string header_message = "Processing " + std::to_string(result_files.size()) + " result files.";
     header(header_message, max_length, "*");
     platform::JsonValidator validator(platform::SchemaV1_0::schema);
@@ -1,15 +1,209 @@
 #include <ArffFiles.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <list>
+#include <mutex>
 #include <set>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <nlohmann/json.hpp>
 #include "Dataset.h"
+#include "Paths.h"
+#include "TextParser.hpp"
+#include "experimental_clfs/ThreadPool.hpp"
 namespace platform {
     const std::string message_dataset_not_loaded = "Dataset not loaded.";
+    //
+    // Binary cache layout (native endianness, version bumped on any change):
+    //   magic, version, for each source file: size & mtime, requested class name,
+    //   class name, n_features, n_samples, features, labels, numeric features mask,
+    //   padding to 8 bytes, X as n_features x n_samples float32, y as n_samples int32
+    //
+    namespace {
+        const char cache_magic[8] = { 'P', 'L', 'A', 'T', 'D', 'S', 'E', 'T' };
+        const uint32_t cache_version = 1;
+        const std::string cache_extension = ".platform.bin";
+        const std::string stats_extension = ".platform.stats.json";
+        // Folder of the binary cache and statistics files, empty for next to the source files, "none" to disable them
+        std::string cache_folder;
+        const int stats_version = 1;
+        struct FileSignature {
+            uint64_t size;
+            int64_t mtime;
+        };
+        bool signature(const std::string& fileName, FileSignature& result)
+        {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(fileName, ec);
+            if (ec) return false;
+            auto mtime = std::filesystem::last_write_time(fileName, ec);
+            if (ec) return false;
+            result.size = static_cast<uint64_t>(size);
+            result.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+            return true;
+        }
+        // Private (copy on write) memory map of a whole file, released on destruction
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& fileName)
+            {
+                int fd = ::open(fileName.c_str(), O_RDONLY);
+                if (fd < 0) return;
+                struct stat st;
+                if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void* addr = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED) {
+                        data = static_cast<const char*>(addr);
+                        size = static_cast<size_t>(st.st_size);
+                    }
+                }
+                ::close(fd);
+            }
+            ~MappedFile()
+            {
+                if (data != nullptr)
+                    ::munmap(const_cast<char*>(data), size);
+            }
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            const char* data = nullptr;
+            size_t size = 0;
+        };
+        class CacheReader {
+        public:
+            CacheReader(const char* data, size_t size) : begin(data), current(data), end(data + size) {}
+            const char* take(size_t bytes)
+            {
+                if (static_cast<size_t>(end - current) < bytes) return nullptr;
+                auto result = current;
+                current += bytes;
+                return result;
+            }
+            template<typename T>
+            bool read(T& value)
+            {
+                auto ptr = take(sizeof(T));
+                if (ptr == nullptr) return false;
+                std::memcpy(&value, ptr, sizeof(T));
+                return true;
+            }
+            bool read(std::string& value)
+            {
+                uint32_t length;
+                if (!read(length)) return false;
+                auto ptr = take(length);
+                if (ptr == nullptr) return false;
+                value.assign(ptr, length);
+                return true;
+            }
+            bool read(std::vector<std::string>& values)
+            {
+                uint32_t count;
+                if (!read(count)) return false;
+                values.resize(count);
+                for (auto& value : values) {
+                    if (!read(value)) return false;
+                }
+                return true;
+            }
+            bool align()
+            {
+                auto offset = static_cast<size_t>(current - begin);
+                return take((8 - offset % 8) % 8) != nullptr;
+            }
+        private:
+            const char* begin;
+            const char* current;
+            const char* end;
+        };
+        class CacheWriter {
+        public:
+            explicit CacheWriter(std::ofstream& file) : file(file) {}
+            void write(const void* data, size_t bytes)
+            {
+                file.write(static_cast<const char*>(data), bytes);
+                offset += bytes;
+            }
+            template<typename T>
+            void write(const T& value) { write(&value, sizeof(T)); }
+            void write(const std::string& value)
+            {
+                write(static_cast<uint32_t>(value.size()));
+                write(value.data(), value.size());
+            }
+            void write(const std::vector<std::string>& values)
+            {
+                write(static_cast<uint32_t>(values.size()));
+                for (const auto& value : values) {
+                    write(value);
+                }
+            }
+            void align()
+            {
+                const char padding[8] = { 0 };
+                write(padding, (8 - offset % 8) % 8);
+            }
+        private:
+            std::ofstream& file;
+            size_t offset = 0;
+        };
+        // Discretized folds saved in the disk cache (disc_cache/), see Dataset::getFoldTensors
+        bool discretization_disk = true;
+        size_t discretization_memory = size_t(64) << 20;
+        size_t discretization_quota = size_t(2048) << 20;
+        std::mutex discretization_quota_mutex;
+        const int64_t discretization_version = 1;
+        std::string hex(uint64_t value)
+        {
+            std::stringstream stream;
+            stream << std::hex << std::setw(16) << std::setfill('0') << value;
+            return stream.str();
+        }
+        int64_t as_int64(uint64_t value)
+        {
+            int64_t result;
+            std::memcpy(&result, &value, sizeof(result));
+            return result;
+        }
+        //
+        // Loaded datasets of the shared catalogs, most recently used first, with their memory
+        //
+        struct LoadedDatasets {
+            std::mutex mutex;
+            std::list<std::pair<Dataset*, size_t>> order;
+            size_t total = 0;
+            size_t budget = 0;
+        };
+        LoadedDatasets& loaded_datasets()
+        {
+            static LoadedDatasets instance;
+            return instance;
+        }
+        // FNV-1a hash
+        void hash_bytes(uint64_t& hash, const void* data, size_t bytes)
+        {
+            auto ptr = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; ++i) {
+                hash ^= ptr[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+    }
     Dataset::Dataset(const Dataset& dataset) :
-        path(dataset.path), name(dataset.name), className(dataset.className), n_samples(dataset.n_samples),
+        path(dataset.path), name(dataset.name), className(dataset.className), requestedClassName(dataset.requestedClassName), n_samples(dataset.n_samples),
         n_features(dataset.n_features), numericFeatures(dataset.numericFeatures), features(dataset.features),
-        states(dataset.states), loaded(dataset.loaded), discretize(dataset.discretize), X(dataset.X), y(dataset.y),
-        X_train(dataset.X_train), X_test(dataset.X_test), Xv(dataset.Xv), yv(dataset.yv),
+        states(dataset.states), loaded(dataset.loaded.load()), discretize(dataset.discretize), X(dataset.X), y(dataset.y),
+        X_train(dataset.X_train), X_test(dataset.X_test),
         fileType(dataset.fileType)
     {
     }
@@ -48,7 +242,8 @@ namespace platform {
     int Dataset::getNClasses() const
     {
         if (loaded) {
-            return *std::max_element(yv.begin(), yv.end()) + 1;
+            auto labels_y = getVectors().second;
+            return *std::max_element(labels_y.begin(), labels_y.end()) + 1;
         } else {
             throw std::invalid_argument(message_dataset_not_loaded);
         }
@@ -65,15 +260,32 @@ namespace platform {
     std::vector<int> Dataset::getClassesCounts() const
     {
         if (loaded) {
-            std::vector<int> counts(*std::max_element(yv.begin(), yv.end()) + 1);
-            for (auto y : yv) {
-                counts[y]++;
+            auto labels_y = getVectors().second;
+            std::vector<int> counts(*std::max_element(labels_y.begin(), labels_y.end()) + 1);
+            for (auto label : labels_y) {
+                counts[label]++;
             }
             return counts;
         } else {
             throw std::invalid_argument(message_dataset_not_loaded);
         }
     }
+    DatasetStats Dataset::getStats()
+    {
+        DatasetStats stats;
+        if (load_stats(stats)) {
+            return stats;
+        }
+        load();
+        stats.samples = n_samples;
+        stats.features = n_features;
+        stats.numeric = std::count(numericFeatures.begin(), numericFeatures.end(), true);
+        stats.classes_counts = getClassesCounts();
+        stats.classes = stats.classes_counts.size();
+        stats.labels = labels;
+        save_stats(stats);
+        return stats;
+    }
     std::map<std::string, std::vector<int>> Dataset::getStates() const
     {
         if (loaded) {
@@ -82,13 +294,17 @@ namespace platform {
             throw std::invalid_argument(message_dataset_not_loaded);
         }
     }
-    pair<std::vector<std::vector<float>>&, std::vector<int>&> Dataset::getVectors()
+    std::pair<std::vector<std::span<const float>>, std::span<const int>> Dataset::getVectors() const
     {
-        if (loaded) {
-            return { Xv, yv };
-        } else {
+        if (!loaded) {
             throw std::invalid_argument(message_dataset_not_loaded);
         }
+        std::vector<std::span<const float>> columns;
+        auto data_X = X.data_ptr<float>();
+        for (long i = 0; i < n_features; ++i) {
+            columns.emplace_back(data_X + i * n_samples, n_samples);
+        }
+        return { columns, std::span<const int>(y.data_ptr<int32_t>(), n_samples) };
     }
     pair<torch::Tensor&, torch::Tensor&> Dataset::getTensors()
     {
@@ -100,36 +316,21 @@ namespace platform {
     }
     void Dataset::load_csv()
     {
-        ifstream file(path + "/" + name + ".csv");
-        if (!file.is_open()) {
+        MappedFile mapped(path + "/" + name + ".csv");
+        if (mapped.data == nullptr) {
             throw std::invalid_argument("Unable to open dataset file.");
         }
-        labels.clear();
-        std::string line;
-        getline(file, line);
-        std::vector<std::string> tokens = split(line, ',');
+        auto parser = TextParser(mapped.data, mapped.size, TextParser::Format{ ',' });
+        auto tokens = parser.header();
         features = std::vector<std::string>(tokens.begin(), tokens.end() - 1);
         if (className == "-1") {
             className = tokens.back();
         }
-        for (auto i = 0; i < features.size(); ++i) {
-            Xv.push_back(std::vector<float>());
-        }
-        while (getline(file, line)) {
-            tokens = split(line, ',');
-            for (auto i = 0; i < features.size(); ++i) {
-                Xv[i].push_back(stof(tokens[i]));
-            }
-            auto label = trim(tokens.back());
-            if (find(labels.begin(), labels.end(), label) == labels.end()) {
-                labels.push_back(label);
-            }
-            yv.push_back(stoi(label));
-        }
-        file.close();
+        parser.parse(std::vector<bool>(features.size(), false), Xv, yv, labels);
     }
-    void Dataset::computeStates()
+    std::map<std::string, std::vector<int>> Dataset::computeStates(const torch::Tensor& X_train, const torch::Tensor& X_test, const torch::Tensor& y_train, const torch::Tensor& y_test) const
     {
+        std::map<std::string, std::vector<int>> states;
         for (int i = 0; i < features.size(); ++i) {
             auto [max_train, _1] = torch::max(X_train.index({ i, "..." }), 0);
             auto [max_test, _2] = torch::max(X_test.index({ i, "..." }), 0);
@@ -142,6 +343,7 @@ namespace platform {
         auto max_value = std::max(max_train.item<int>(), max_test.item<int>());
         states[className] = std::vector<int>(max_value + 1);
         iota(begin(states.at(className)), end(states.at(className)), 0);
+        return states;
     }
     void Dataset::load_arff()
     {
@@ -156,56 +358,20 @@ namespace platform {
         transform(attributes.begin(), attributes.end(), back_inserter(features), [](const auto& attribute) { return attribute.first; });
         labels = arff.getLabels();
     }
-    std::vector<std::string> tokenize(std::string line)
-    {
-        std::vector<std::string> tokens;
-        for (auto i = 0; i < line.size(); ++i) {
-            if (line[i] == ' ' || line[i] == '\t' || line[i] == '\n') {
-                std::string token = line.substr(0, i);
-                tokens.push_back(token);
-                line.erase(line.begin(), line.begin() + i + 1);
-                i = 0;
-                while (line[i] == ' ' || line[i] == '\t' || line[i] == '\n')
-                    line.erase(line.begin(), line.begin() + i + 1);
-            }
-        }
-        if (line.size() > 0) {
-            tokens.push_back(line);
-        }
-        return tokens;
-    }
     void Dataset::load_rdata()
     {
-        ifstream file(path + "/" + name + "_R.dat");
-        if (!file.is_open()) {
+        MappedFile mapped(path + "/" + name + "_R.dat");
+        if (mapped.data == nullptr) {
             throw std::invalid_argument("Unable to open dataset file.");
         }
-        std::string line;
-        labels.clear();
-        getline(file, line);
-        line = ArffFiles::trim(line);
-        std::vector<std::string> tokens = tokenize(line);
-        transform(tokens.begin(), tokens.end() - 1, back_inserter(features), [](const auto& attribute) { return ArffFiles::trim(attribute); });
+        // Blank separated columns, the rows start with the instance number
+        auto parser = TextParser(mapped.data, mapped.size, TextParser::Format{ ' ', true });
+        auto tokens = parser.header();
+        features = std::vector<std::string>(tokens.begin(), tokens.end() - 1);
         if (className == "-1") {
-            className = ArffFiles::trim(tokens.back());
-        }
-        for (auto i = 0; i < features.size(); ++i) {
-            Xv.push_back(std::vector<float>());
-        }
-        while (getline(file, line)) {
-            tokens = tokenize(line);
-            // We have to skip the first token, which is the instance number.
-            for (auto i = 1; i < features.size() + 1; ++i) {
-                const float value = stof(tokens[i]);
-                Xv[i - 1].push_back(value);
-            }
-            auto label = trim(tokens.back());
-            if (find(labels.begin(), labels.end(), label) == labels.end()) {
-                labels.push_back(label);
-            }
-            yv.push_back(stoi(label));
+            className = tokens.back();
         }
-        file.close();
+        parser.parse(std::vector<bool>(features.size(), false), Xv, yv, labels);
     }
     void Dataset::load_csv_json()
     {
@@ -234,77 +400,21 @@ namespace platform {
                 }
             }
         }
-        // 2. Read CSV
-        std::ifstream file(path + name + ".csv");
-        if (!file.is_open()) {
+        // 2. Read CSV, skipping rows with missing or corrupt data
+        MappedFile mapped(path + name + ".csv");
+        if (mapped.data == nullptr) {
             throw std::invalid_argument("Unable to open dataset file: " + path + name + ".csv");
         }
-        labels.clear();
-        std::string line;
-        // Read header
-        getline(file, line);
-        std::vector<std::string> header = split(line, ',');
+        auto parser = TextParser(mapped.data, mapped.size, TextParser::Format{ ',', false, true, false });
+        auto header = parser.header();
         // All columns except the last are features (target is last column)
         features = std::vector<std::string>(header.begin(), header.end() - 1);
+        // Categorical features and the target are factorized
+        std::vector<bool> categorical(features.size());
         for (auto i = 0; i < features.size(); ++i) {
-            features[i] = trim(features[i]);
-            Xv.push_back(std::vector<float>());
-        }
-        // Factorization maps for categorical features (per feature index)
-        std::vector<std::map<std::string, int>> factorMaps(features.size());
-        // Factorization map for target
-        std::map<std::string, int> labelMap;
-        // Read data rows, skipping rows with missing or corrupt data
-        auto expectedColumns = features.size() + 1;
-        while (getline(file, line)) {
-            if (line.empty()) continue;
-            std::vector<std::string> tokens = split(line, ',');
-            // Check for correct number of columns
-            if (tokens.size() != expectedColumns) continue;
-            // Check for missing values in any column
-            bool has_missing = false;
-            for (auto i = 0; i < tokens.size(); ++i) {
-                if (trim(tokens[i]).empty()) {
-                    has_missing = true;
-                    break;
-                }
-            }
-            if (has_missing) continue;
-            // Parse feature values into a buffer before committing
-            bool has_invalid = false;
-            std::vector<float> row_values(features.size());
-            for (auto i = 0; i < features.size(); ++i) {
-                auto value = trim(tokens[i]);
-                if (numericSet.count(features[i])) {
-                    // Numeric feature
-                    try {
-                        row_values[i] = stof(value);
-                    } catch (const std::invalid_argument&) {
-                        has_invalid = true;
-                        break;
-                    }
-                } else {
-                    // Categorical feature → factorize
-                    if (factorMaps[i].find(value) == factorMaps[i].end()) {
-                        factorMaps[i][value] = static_cast<int>(factorMaps[i].size());
-                    }
-                    row_values[i] = static_cast<float>(factorMaps[i][value]);
-                }
-            }
-            if (has_invalid) continue;
-            // All values valid — commit to dataset
-            for (auto i = 0; i < features.size(); ++i) {
-                Xv[i].push_back(row_values[i]);
-            }
-            // Target (last column) → factorize
-            auto label = trim(tokens.back());
-            if (labelMap.find(label) == labelMap.end()) {
-                labelMap[label] = static_cast<int>(labelMap.size());
-                labels.push_back(label);
-            }
-            yv.push_back(labelMap[label]);
+            categorical[i] = numericSet.count(features[i]) == 0;
         }
-        file.close();
+        parser.parse(categorical, Xv, yv, labels);
         // 3. Build numericFeatures[] from metadata
         numericFeatures.resize(features.size(), false);
         numericFeaturesIdx.clear();
@@ -315,22 +425,399 @@ namespace platform {
             }
         }
     }
-    void Dataset::load()
+    std::vector<std::string> Dataset::sourceFiles() const
     {
-        if (loaded) {
-            return;
-        }
         if (fileType == CSV) {
-            load_csv();
+            return { path + "/" + name + ".csv" };
         } else if (fileType == ARFF) {
-            load_arff();
+            return { path + "/" + name + ".arff" };
         } else if (fileType == RDATA) {
-            load_rdata();
-        } else if (fileType == CSVJSON) {
-            load_csv_json();
+            return { path + "/" + name + "_R.dat" };
+        }
+        return { path + name + ".csv", path + name + "_metadata.json" };
+    }
+    std::string Dataset::cacheFile(const std::string& extension) const
+    {
+        auto source = sourceFiles().front();
+        if (cache_folder.empty()) {
+            return source + extension;
+        }
+        if (cache_folder == "none") {
+            return "";
+        }
+        return cache_folder + "/" + std::filesystem::path(source).filename().string() + extension;
+    }
+    void Dataset::setCacheFolder(const std::string& folder)
+    {
+        cache_folder = folder;
+        if (!folder.empty() && folder != "none") {
+            std::error_code ec;
+            std::filesystem::create_directories(folder, ec);
+        }
+    }
+    bool Dataset::load_cache(const std::string& requestedClassName)
+    {
+        // Returns false, leaving the dataset untouched, if the cache is missing, stale or corrupt
+        auto fileName = cacheFile(cache_extension);
+        if (fileName.empty()) {
+            return false;
         }
-        n_samples = Xv[0].size();
-        n_features = Xv.size();
+        auto mapped = std::make_shared<MappedFile>(fileName);
+        if (mapped->data == nullptr) {
+            return false;
+        }
+        CacheReader reader(mapped->data, mapped->size);
+        auto magic = reader.take(sizeof(cache_magic));
+        uint32_t version;
+        if (magic == nullptr || std::memcmp(magic, cache_magic, sizeof(cache_magic)) != 0 || !reader.read(version) || version != cache_version) {
+            return false;
+        }
+        for (const auto& source : sourceFiles()) {
+            FileSignature current, stored;
+            if (!signature(source, current) || !reader.read(stored) || stored.size != current.size || stored.mtime != current.mtime) {
+                return false;
+            }
+        }
+        std::string storedRequested, storedClassName;
+        int64_t stored_features, stored_samples;
+        std::vector<std::string> storedFeatures, storedLabels;
+        if (!reader.read(storedRequested) || storedRequested != requestedClassName || !reader.read(storedClassName)
+            || !reader.read(stored_features) || !reader.read(stored_samples) || !reader.read(storedFeatures) || !reader.read(storedLabels)
+            || stored_features <= 0 || stored_samples <= 0 || storedFeatures.size() != static_cast<size_t>(stored_features)) {
+            return false;
+        }
+        auto mask = reader.take(stored_features);
+        if (mask == nullptr || !reader.align()) {
+            return false;
+        }
+        auto data_X = reinterpret_cast<const float*>(reader.take(sizeof(float) * stored_features * stored_samples));
+        auto data_y = reinterpret_cast<const int32_t*>(reader.take(sizeof(int32_t) * stored_samples));
+        if (data_X == nullptr || data_y == nullptr) {
+            return false;
+        }
+        className = storedClassName;
+        features = storedFeatures;
+        labels = storedLabels;
+        // X & y are views of the mapped file, which lives as long as their storage
+        auto keep = [mapped](void*) {};
+        X = torch::from_blob(const_cast<float*>(data_X), { stored_features, stored_samples }, keep, torch::kFloat32);
+        y = torch::from_blob(const_cast<int32_t*>(data_y), { stored_samples }, keep, torch::kInt32);
+        if (fileType == CSVJSON) {
+            numericFeatures.resize(stored_features);
+            numericFeaturesIdx.clear();
+            for (int64_t i = 0; i < stored_features; ++i) {
+                numericFeatures[i] = mask[i] != 0;
+                if (numericFeatures[i])
+                    numericFeaturesIdx.push_back(i);
+            }
+        }
+        return true;
+    }
+    void Dataset::save_cache(const std::string& requestedClassName) const
+    {
+        // The cache is an optimization, any failure writing it is silently ignored
+        std::vector<FileSignature> signatures;
+        for (const auto& source : sourceFiles()) {
+            FileSignature sig;
+            if (!signature(source, sig)) {
+                return;
+            }
+            signatures.push_back(sig);
+        }
+        auto fileName = cacheFile(cache_extension);
+        if (fileName.empty()) {
+            return;
+        }
+        auto tmpName = fileName + "." + std::to_string(::getpid()) + ".tmp";
+        {
+            std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return;
+            }
+            CacheWriter writer(file);
+            writer.write(cache_magic, sizeof(cache_magic));
+            writer.write(cache_version);
+            for (const auto& sig : signatures) {
+                writer.write(sig);
+            }
+            writer.write(requestedClassName);
+            writer.write(className);
+            writer.write(static_cast<int64_t>(n_features));
+            writer.write(static_cast<int64_t>(n_samples));
+            writer.write(features);
+            writer.write(labels);
+            for (int i = 0; i < n_features; ++i) {
+                writer.write(static_cast<uint8_t>(numericFeatures[i] ? 1 : 0));
+            }
+            writer.align();
+            writer.write(X.data_ptr<float>(), sizeof(float) * n_features * n_samples);
+            writer.write(y.data_ptr<int32_t>(), sizeof(int32_t) * n_samples);
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(tmpName);
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpName, fileName, ec);
+        if (ec) {
+            std::filesystem::remove(tmpName, ec);
+        }
+    }
+    //
+    // Statistics file: json with the signatures of the source files, the requested class name and the
+    // DatasetStats values. It is written by getStats and ignored when any source file has changed
+    //
+    bool Dataset::load_stats(DatasetStats& stats) const
+    {
+        auto fileName = cacheFile(stats_extension);
+        if (fileName.empty()) {
+            return false;
+        }
+        try {
+            std::ifstream file(fileName);
+            if (!file.is_open()) {
+                return false;
+            }
+            auto data = nlohmann::json::parse(file);
+            if (data.value("version", 0) != stats_version || data.value("class_name", "") != requestedClassName) {
+                return false;
+            }
+            auto sources = sourceFiles();
+            if (data["sources"].size() != sources.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < sources.size(); ++i) {
+                FileSignature current;
+                if (!signature(sources[i], current) || data["sources"][i]["size"].get<uint64_t>() != current.size || data["sources"][i]["mtime"].get<int64_t>() != current.mtime) {
+                    return false;
+                }
+            }
+            stats.samples = data["samples"].get<long>();
+            stats.features = data["features"].get<long>();
+            stats.numeric = data["numeric"].get<long>();
+            stats.classes = data["classes"].get<int>();
+            stats.classes_counts = data["classes_counts"].get<std::vector<int>>();
+            stats.labels = data["labels"].get<std::vector<std::string>>();
+            return true;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    void Dataset::save_stats(const DatasetStats& stats) const
+    {
+        // As the binary cache, the statistics file is an optimization and any failure writing it is ignored
+        auto sources = nlohmann::json::array();
+        for (const auto& source : sourceFiles()) {
+            FileSignature sig;
+            if (!signature(source, sig)) {
+                return;
+            }
+            sources.push_back({ { "size", sig.size }, { "mtime", sig.mtime } });
+        }
+        nlohmann::json data = {
+            { "version", stats_version },
+            { "sources", sources },
+            { "class_name", requestedClassName },
+            { "samples", stats.samples },
+            { "features", stats.features },
+            { "numeric", stats.numeric },
+            { "classes", stats.classes },
+            { "classes_counts", stats.classes_counts },
+            { "labels", stats.labels }
+        };
+        auto fileName = cacheFile(stats_extension);
+        if (fileName.empty()) {
+            return;
+        }
+        auto tmpName = fileName + "." + std::to_string(::getpid()) + ".tmp";
+        std::error_code ec;
+        {
+            std::ofstream file(tmpName, std::ios::trunc);
+            if (!file.is_open()) {
+                return;
+            }
+            file << data.dump();
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(tmpName, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(tmpName, fileName, ec);
+        if (ec) {
+            std::filesystem::remove(tmpName, ec);
+        }
+    }
+    void Dataset::setDiscretizationCache(bool enabled)
+    {
+        discretization_disk = enabled;
+    }
+    void Dataset::setDiscretizationLimits(size_t memory, size_t disk)
+    {
+        discretization_memory = memory;
+        discretization_quota = disk;
+    }
+    void Dataset::setMemoryBudget(size_t bytes)
+    {
+        auto& registry = loaded_datasets();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.budget = bytes;
+    }
+    size_t Dataset::memorySize() const
+    {
+        // X & y and the discretized folds kept
+        std::lock_guard<std::mutex> lock(discretization_mutex);
+        return (sizeof(float) * n_features + sizeof(int32_t)) * n_samples + discretized_bytes;
+    }
+    void Dataset::used()
+    {
+        //
+        // Moves the dataset to the front of the list and unloads the least recently used ones over the budget.
+        // The victims are released without holding any other lock; the datasets in use are pinned and never
+        // released (see Dataset::Pin), a victim pinned in the meantime registers itself again when pinned
+        //
+        auto& registry = loaded_datasets();
+        std::vector<Dataset*> victims;
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto item = std::find_if(registry.order.begin(), registry.order.end(), [this](const auto& entry) { return entry.first == this; });
+            if (item != registry.order.end()) {
+                // Its size changes with the discretized folds kept
+                registry.order.splice(registry.order.begin(), registry.order, item);
+                registry.total -= item->second;
+                item->second = memorySize();
+                registry.total += item->second;
+            } else {
+                registry.order.emplace_front(this, memorySize());
+                registry.total += registry.order.front().second;
+            }
+            // Pinned datasets are kept; release() checks it again as a dataset can be pinned meanwhile
+            auto candidate = registry.order.end();
+            while (registry.budget > 0 && registry.total > registry.budget && candidate != std::next(registry.order.begin())) {
+                --candidate;
+                if (candidate->first->pins > 0) {
+                    continue;
+                }
+                registry.total -= candidate->second;
+                victims.push_back(candidate->first);
+                candidate = registry.order.erase(candidate);
+            }
+        }
+        for (auto victim : victims) {
+            victim->release();
+        }
+    }
+    void Dataset::unload()
+    {
+        if (tracked) {
+            auto& registry = loaded_datasets();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto item = std::find_if(registry.order.begin(), registry.order.end(), [this](const auto& entry) { return entry.first == this; });
+            if (item != registry.order.end()) {
+                registry.total -= item->second;
+                registry.order.erase(item);
+            }
+        }
+        release();
+    }
+    void Dataset::release()
+    {
+        std::lock_guard<std::mutex> lock(load_mutex);
+        if (!loaded || pins > 0) {
+            return;
+        }
+        loaded = false;
+        Xv = std::vector<std::vector<float>>();
+        yv = std::vector<int>();
+        X = y = X_train = X_test = y_train = y_test = torch::Tensor();
+        features.clear();
+        labels.clear();
+        states.clear();
+        numericFeatures.clear();
+        className = requestedClassName;
+        std::lock_guard<std::mutex> folds_lock(discretization_mutex);
+        discretized_folds.clear();
+        discretized_bytes = 0;
+    }
+    void Dataset::load()
+    {
+        {
+            std::lock_guard<std::mutex> lock(load_mutex);
+            if (!loaded) {
+                read();
+            }
+        }
+        if (tracked) {
+            used();
+        }
+    }
+    Dataset::Pin Dataset::pin()
+    {
+        return Pin(*this);
+    }
+    Dataset::Pin::Pin(Dataset& dataset) : dataset(&dataset)
+    {
+        {
+            std::lock_guard<std::mutex> lock(dataset.load_mutex);
+            dataset.pins++;
+            if (!dataset.loaded) {
+                try {
+                    dataset.read();
+                }
+                catch (...) {
+                    dataset.pins--;
+                    throw;
+                }
+            }
+        }
+        if (dataset.tracked) {
+            dataset.used();
+        }
+    }
+    Dataset::Pin& Dataset::Pin::operator=(Pin&& other) noexcept
+    {
+        if (this != &other) {
+            Pin old(std::move(*this));
+            dataset = std::exchange(other.dataset, nullptr);
+        }
+        return *this;
+    }
+    Dataset::Pin::~Pin()
+    {
+        if (dataset != nullptr) {
+            std::lock_guard<std::mutex> lock(dataset->load_mutex);
+            dataset->pins--;
+        }
+    }
+    void Dataset::read()
+    {
+        bool cached = load_cache(requestedClassName);
+        if (!cached) {
+            if (fileType == CSV) {
+                load_csv();
+            } else if (fileType == ARFF) {
+                load_arff();
+            } else if (fileType == RDATA) {
+                load_rdata();
+            } else if (fileType == CSVJSON) {
+                load_csv_json();
+            }
+            n_samples = Xv[0].size();
+            n_features = Xv.size();
+            X = torch::empty({ n_features, n_samples }, torch::kFloat32);
+            auto data_X = X.data_ptr<float>();
+            for (int i = 0; i < n_features; ++i) {
+                std::memcpy(data_X + i * n_samples, Xv[i].data(), sizeof(float) * n_samples);
+                Xv[i] = std::vector<float>();
+            }
+            y = torch::tensor(yv, torch::kInt32);
+            Xv = std::vector<std::vector<float>>();
+            yv = std::vector<int>();
+        }
+        n_features = X.size(0);
+        n_samples = X.size(1);
         if (fileType != CSVJSON) {
             // CSVJSON builds numericFeatures inside load_csv_json()
             if (numericFeaturesIdx.size() == 0) {
@@ -349,52 +836,271 @@ namespace platform {
                 }
             }
         }
-        // Build Tensors
-        X = torch::zeros({ n_features, n_samples }, torch::kFloat32);
-        for (int i = 0; i < features.size(); ++i) {
-            X.index_put_({ i,  "..." }, torch::tensor(Xv[i], torch::kFloat32));
+        if (!cached) {
+            save_cache(requestedClassName);
         }
-        y = torch::tensor(yv, torch::kInt32);
         loaded = true;
     }
     std::tuple<torch::Tensor&, torch::Tensor&, torch::Tensor&, torch::Tensor&> Dataset::getTrainTestTensors(std::vector<int>& train, std::vector<int>& test)
+    {
+        auto fold = getFoldTensors(train, test);
+        X_train = fold.X_train;
+        X_test = fold.X_test;
+        y_train = fold.y_train;
+        y_test = fold.y_test;
+        if (discretize) {
+            states = fold.states;
+        }
+        return { X_train, X_test, y_train, y_test };
+    }
+    FoldTensors Dataset::getFoldTensors(const std::vector<int>& train, const std::vector<int>& test) const
     {
         if (!loaded) {
             throw std::invalid_argument(message_dataset_not_loaded);
         }
+        FoldTensors fold;
         auto train_t = torch::tensor(train);
-        int samples_train = train.size();
-        int samples_test = test.size();
         auto test_t = torch::tensor(test);
-        X_train = X.index({ "...", train_t });
-        y_train = y.index({ train_t });
-        X_test = X.index({ "...", test_t });
-        y_test = y.index({ test_t });
-        if (discretize) {
-            auto discretizer = Discretization::instance()->create(discretizer_algorithm);
-            auto X_train_d = torch::zeros({ n_features, samples_train }, torch::kInt32);
-            auto X_test_d = torch::zeros({ n_features, samples_test }, torch::kInt32);
-            for (auto feature = 0; feature < n_features; ++feature) {
-                if (numericFeatures[feature]) {
-                    auto feature_train = X_train.index({ feature, "..." });
-                    auto feature_test = X_test.index({ feature, "..." });
-                    auto feature_train_disc = discretizer->fit_transform_t(feature_train, y_train);
-                    auto feature_test_disc = discretizer->transform_t(feature_test);
-                    X_train_d.index_put_({ feature, "..." }, feature_train_disc);
-                    X_test_d.index_put_({ feature, "..." }, feature_test_disc);
-                } else {
-                    X_train_d.index_put_({ feature, "..." }, X_train.index({ feature, "..." }).to(torch::kInt32));
-                    X_test_d.index_put_({ feature, "..." }, X_test.index({ feature, "..." }).to(torch::kInt32));
+        fold.X_train = X.index({ "...", train_t });
+        fold.y_train = y.index({ train_t });
+        fold.X_test = X.index({ "...", test_t });
+        fold.y_test = y.index({ test_t });
+        if (discretize && std::none_of(numericFeatures.begin(), numericFeatures.end(), [](bool numeric) { return numeric; })) {
+            // Nothing to discretize, the fold is the categorical codes as they are, without going through the caches
+            fold.X_train = fold.X_train.to(torch::kInt32);
+            fold.X_test = fold.X_test.to(torch::kInt32);
+            fold.states = computeStates(fold.X_train, fold.X_test, fold.y_train, fold.y_test);
+        } else if (discretize) {
+            //
+            // The discretization of a fold only depends on the data and the train/test split, so it is
+            // looked up first in the folds kept by this dataset, then in the disk cache, before computing it
+            //
+            auto [data_hash, split_hash] = discretizationHashes(train, test);
+            auto prefix = name + "_" + discretizer_algorithm + "_";
+            auto key = prefix + hex(data_hash) + "_" + hex(split_hash);
+            if (findDiscretized(key, fold)) {
+                return fold;
+            }
+            bool found = false;
+            std::string fileName;
+            if (discretization_disk) {
+                fileName = Paths::discretizationCache() + key + ".pt";
+                if (!discretization_pruned.exchange(true)) {
+                    pruneDiscretized(prefix, prefix + hex(data_hash) + "_");
                 }
+                found = loadDiscretized(fileName, data_hash, split_hash, fold);
             }
-            X_train = X_train_d;
-            X_test = X_test_d;
-            assert(X_train.dtype() == torch::kInt32);
-            assert(X_test.dtype() == torch::kInt32);
-            computeStates();
+            if (found) {
+                fold.states = computeStates(fold.X_train, fold.X_test, fold.y_train, fold.y_test);
+            } else {
+                discretizeFold(fold);
+                if (discretization_disk) {
+                    // Unique temporary name, several threads of several processes may write the same fold
+                    std::stringstream tmpName;
+                    tmpName << fileName << "." << ::getpid() << "." << std::this_thread::get_id() << ".tmp";
+                    auto tag = torch::tensor({ discretization_version, as_int64(data_hash), as_int64(split_hash) }, torch::kInt64);
+                    try {
+                        torch::save(std::vector<torch::Tensor>{ fold.X_train, fold.X_test, tag }, tmpName.str());
+                        std::filesystem::rename(tmpName.str(), fileName);
+                        limitDiscretizedDisk();
+                    }
+                    catch (const std::exception&) {
+                        std::error_code ec;
+                        std::filesystem::remove(tmpName.str(), ec);
+                    }
+                }
+            }
+            keepDiscretized(key, fold);
         }
-        assert(y_train.dtype() == torch::kInt32);
-        assert(y_test.dtype() == torch::kInt32);
-        return { X_train, X_test, y_train, y_test };
+        assert(fold.y_train.dtype() == torch::kInt32);
+        assert(fold.y_test.dtype() == torch::kInt32);
+        return fold;
+    }
+    std::pair<uint64_t, uint64_t> Dataset::discretizationHashes(const std::vector<int>& train, const std::vector<int>& test) const
+    {
+        // Identify the data (source files, class, numeric features) and the split of the fold
+        uint64_t data_hash = 14695981039346656037ULL;
+        for (const auto& source : sourceFiles()) {
+            FileSignature sig{ 0, 0 };
+            signature(source, sig);
+            hash_bytes(data_hash, &sig, sizeof(sig));
+        }
+        hash_bytes(data_hash, className.data(), className.size());
+        for (bool numeric : numericFeatures) {
+            hash_bytes(data_hash, &numeric, sizeof(numeric));
+        }
+        uint64_t split_hash = 14695981039346656037ULL;
+        uint64_t sizes[2] = { train.size(), test.size() };
+        hash_bytes(split_hash, sizes, sizeof(sizes));
+        hash_bytes(split_hash, train.data(), sizeof(int) * train.size());
+        hash_bytes(split_hash, test.data(), sizeof(int) * test.size());
+        return { data_hash, split_hash };
+    }
+    bool Dataset::loadDiscretized(const std::string& fileName, uint64_t data_hash, uint64_t split_hash, FoldTensors& fold) const
+    {
+        // Only a file written for the same data and split, with the shape of the fold, is accepted
+        if (!std::filesystem::exists(fileName)) {
+            return false;
+        }
+        try {
+            std::vector<torch::Tensor> tensors;
+            torch::load(tensors, fileName);
+            if (tensors.size() != 3 || tensors[2].dtype() != torch::kInt64 || tensors[2].numel() != 3) {
+                return false;
+            }
+            auto tag = tensors[2].data_ptr<int64_t>();
+            if (tag[0] != discretization_version || tag[1] != as_int64(data_hash) || tag[2] != as_int64(split_hash)) {
+                return false;
+            }
+            for (int i = 0; i < 2; ++i) {
+                const auto& source = i == 0 ? fold.X_train : fold.X_test;
+                if (tensors[i].dtype() != torch::kInt32 || tensors[i].dim() != 2 || tensors[i].size(0) != source.size(0) || tensors[i].size(1) != source.size(1)) {
+                    return false;
+                }
+            }
+            fold.X_train = tensors[0];
+            fold.X_test = tensors[1];
+            // The modification time tells the least recently used files when the disk cache is over its quota
+            std::error_code ec;
+            std::filesystem::last_write_time(fileName, std::filesystem::file_time_type::clock::now(), ec);
+            return true;
+        }
+        catch (const std::exception&) {
+            // Unreadable cache file, the fold is discretized again and the file rewritten
+            return false;
+        }
+    }
+    void Dataset::pruneDiscretized(const std::string& prefix, const std::string& current) const
+    {
+        // Removes the files of this dataset and discretizer written for other versions of its data, or with the
+        // former single hash name
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(Paths::discretizationCache(), ec)) {
+            auto file = entry.path().filename().string();
+            auto length = file.size() - prefix.size();
+            if (file.rfind(prefix, 0) == 0 && file.rfind(current, 0) != 0 && (length == 16 + 3 || length == 2 * 16 + 1 + 3) && entry.path().extension() == ".pt") {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+    }
+    void Dataset::limitDiscretizedDisk()
+    {
+        // Removes the least recently used files (by modification time) while the folder is over its quota. The
+        // files of other processes may be removed meanwhile, so errors are ignored
+        if (discretization_quota == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(discretization_quota_mutex);
+        std::vector<std::tuple<std::filesystem::file_time_type, size_t, std::filesystem::path>> files;
+        size_t total = 0;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(Paths::discretizationCache(), ec)) {
+            if (entry.path().extension() != ".pt") {
+                continue;
+            }
+            auto size = entry.file_size(ec);
+            auto mtime = entry.last_write_time(ec);
+            if (ec) {
+                continue;
+            }
+            files.emplace_back(mtime, size, entry.path());
+            total += size;
+        }
+        if (total <= discretization_quota) {
+            return;
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& [_, size, file] : files) {
+            if (total <= discretization_quota) {
+                break;
+            }
+            std::filesystem::remove(file, ec);
+            total -= size;
+        }
+    }
+    bool Dataset::findDiscretized(const std::string& key, FoldTensors& fold) const
+    {
+        std::lock_guard<std::mutex> lock(discretization_mutex);
+        auto item = std::find_if(discretized_folds.begin(), discretized_folds.end(), [&key](const auto& entry) { return entry.key == key; });
+        if (item == discretized_folds.end()) {
+            return false;
+        }
+        discretized_folds.splice(discretized_folds.begin(), discretized_folds, item);
+        fold.X_train = item->X_train;
+        fold.X_test = item->X_test;
+        fold.states = item->states;
+        return true;
+    }
+    void Dataset::keepDiscretized(const std::string& key, const FoldTensors& fold) const
+    {
+        //
+        // The folds kept count as memory of the dataset: the least recently used ones are dropped to keep them
+        // within their own limit and, with a memory budget, the data and its folds within it
+        //
+        size_t budget;
+        {
+            auto& registry = loaded_datasets();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            budget = registry.budget;
+        }
+        size_t bytes = (fold.X_train.numel() + fold.X_test.numel()) * sizeof(int32_t);
+        size_t data = (sizeof(float) * n_features + sizeof(int32_t)) * n_samples;
+        size_t limit = budget == 0 ? std::numeric_limits<size_t>::max() : (budget > data ? budget - data : 0);
+        if (discretization_memory > 0) {
+            limit = std::min(limit, discretization_memory);
+        }
+        if (bytes > limit) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(discretization_mutex);
+        if (std::any_of(discretized_folds.begin(), discretized_folds.end(), [&key](const auto& entry) { return entry.key == key; })) {
+            return;
+        }
+        discretized_folds.push_front({ key, fold.X_train, fold.X_test, fold.states, bytes });
+        discretized_bytes += bytes;
+        while (discretized_bytes > limit) {
+            discretized_bytes -= discretized_folds.back().bytes;
+            discretized_folds.pop_back();
+        }
+    }
+    void Dataset::discretizeFold(FoldTensors& fold) const
+    {
+        auto X_train_d = torch::empty({ n_features, fold.X_train.size(1) }, torch::kInt32);
+        auto X_test_d = torch::empty({ n_features, fold.X_test.size(1) }, torch::kInt32);
+        std::vector<int> numeric;
+        for (auto feature = 0; feature < n_features; ++feature) {
+            if (numericFeatures[feature]) {
+                numeric.push_back(feature);
+            } else {
+                X_train_d.index({ feature }).copy_(fold.X_train.index({ feature, "..." }).to(torch::kInt32));
+                X_test_d.index({ feature }).copy_(fold.X_test.index({ feature, "..." }).to(torch::kInt32));
+            }
+        }
+        //
+        // Features are independent, so they are discretized in chunks on the shared thread pool, each
+        // chunk with its own discretizer, writing every feature directly in its row of X_train_d and
+        // X_test_d. The pool is the one the classifiers and the experiment jobs use, so the cores are
+        // not oversubscribed; the errors are rethrown by parallel_for
+        //
+        // Threading only pays off with enough features to split
+        const int min_features_per_chunk = 4;
+        auto& pool = ThreadPool::getInstance();
+        int n_numeric = static_cast<int>(numeric.size());
+        int grain = std::max<int>(min_features_per_chunk, (n_numeric + pool.getConcurrency() - 1) / pool.getConcurrency());
+        pool.parallel_for(0, n_numeric, grain, [&](int begin, int end) {
+            auto discretizer = Discretization::instance()->create(discretizer_algorithm);
+            for (int idx = begin; idx < end; ++idx) {
+                auto feature = numeric[idx];
+                auto feature_train_disc = discretizer->fit_transform_t(fold.X_train.index({ feature, "..." }), fold.y_train);
+                auto feature_test_disc = discretizer->transform_t(fold.X_test.index({ feature, "..." }));
+                X_train_d.index({ feature }).copy_(feature_train_disc);
+                X_test_d.index({ feature }).copy_(feature_test_disc);
+            }
+            });
+        fold.X_train = X_train_d;
+        fold.X_test = X_test_d;
+        assert(fold.X_train.dtype() == torch::kInt32);
+        assert(fold.X_test.dtype() == torch::kInt32);
+        fold.states = computeStates(fold.X_train, fold.X_test, fold.y_train, fold.y_test);
     }
-}
\ No newline at end of file
+}
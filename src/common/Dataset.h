@@ -1,18 +1,35 @@
 #ifndef DATASET_H
 #define DATASET_H
 #include <torch/torch.h>
+#include <atomic>
+#include <list>
 #include <map>
+#include <mutex>
+#include <span>
 #include <vector>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <common/DiscretizationRegister.h>
 #include "Utils.h"
 #include "SourceData.h"
 namespace platform {
+    // Train/test split of a dataset computed without modifying it, so several folds can be prepared concurrently
+    struct FoldTensors {
+        torch::Tensor X_train, X_test, y_train, y_test;
+        std::map<std::string, std::vector<int>> states;
+    };
+    // Summary numbers of a dataset, persisted next to its source file so they can be read without loading it
+    struct DatasetStats {
+        long samples{ 0 }, features{ 0 }, numeric{ 0 };
+        int classes{ 0 };
+        std::vector<int> classes_counts;
+        std::vector<std::string> labels;
+    };
     class Dataset {
     public:
         Dataset(const std::string& path, const std::string& name, const std::string& className, bool discretize, fileType_t fileType, std::vector<int> numericFeaturesIdx, std::string discretizer_algo = "none") :
-            path(path), name(name), className(className), discretize(discretize),
+            path(path), name(name), className(className), requestedClassName(className), discretize(discretize),
             loaded(false), fileType(fileType), numericFeaturesIdx(numericFeaturesIdx), discretizer_algorithm(discretizer_algo)
         {
         };
@@ -22,21 +39,53 @@ namespace platform {
         int getNClasses() const;
         std::vector<std::string> getLabels() const; // return the labels factorization result
         std::vector<int> getClassesCounts() const;
+        DatasetStats getStats(); // loads the dataset only if the statistics file is missing or stale
         std::vector<string> getFeatures() const;
         std::map<std::string, std::vector<int>> getStates() const;
-        std::pair<vector<std::vector<float>>&, std::vector<int>&> getVectors();
+        std::pair<std::vector<std::span<const float>>, std::span<const int>> getVectors() const; // views of the features and labels of X and y
         std::pair<torch::Tensor&, torch::Tensor&> getTensors();
         std::tuple<torch::Tensor&, torch::Tensor&, torch::Tensor&, torch::Tensor&> getTrainTestTensors(std::vector<int>& train, std::vector<int>& test);
+        FoldTensors getFoldTensors(const std::vector<int>& train, const std::vector<int>& test) const; // Thread safe version of getTrainTestTensors
         long getNFeatures() const;
         long getNSamples() const;
         std::vector<bool>& getNumericFeatures() { return numericFeatures; }
-        void load();
+        void load(); // thread safe, concurrent calls read the data once
+        //
+        // Keeps a dataset loaded while it lives: the memory budget never releases a pinned dataset, so
+        // its data can be read from several threads while other datasets are loaded
+        //
+        class Pin {
+        public:
+            Pin() = default;
+            explicit Pin(Dataset& dataset);
+            Pin(Pin&& other) noexcept : dataset(std::exchange(other.dataset, nullptr)) {}
+            Pin& operator=(Pin&& other) noexcept;
+            Pin(const Pin&) = delete;
+            Pin& operator=(const Pin&) = delete;
+            ~Pin();
+        private:
+            Dataset* dataset = nullptr;
+        };
+        Pin pin(); // loads the dataset and keeps it loaded until the Pin is destroyed
+        void unload(); // frees the data, a later load() reads it again
         const bool inline isLoaded() const { return loaded; };
+        // Memory of the loaded datasets of the shared catalogs (see Datasets::shared) above which the least recently
+        // used ones are unloaded, 0 for no limit
+        static void setMemoryBudget(size_t bytes);
+        // Folder of the binary cache and statistics files: empty to keep them next to the source files, "none" to
+        // disable them (the datasets are parsed on every load) or a folder, created if needed
+        static void setCacheFolder(const std::string& folder);
+        // Enables (default) or disables the disk cache of the discretized folds (disc_cache/)
+        static void setDiscretizationCache(bool enabled);
+        // Bytes of discretized folds kept in memory by each dataset and bytes of the disk cache above which the least
+        // recently used files are removed, 0 for no limit
+        static void setDiscretizationLimits(size_t memory, size_t disk);
     private:
         std::string path;
         std::string name;
         fileType_t fileType;
         std::string className;
+        std::string requestedClassName; // class name given by the datasets catalog, className may be resolved on load
         long n_samples{ 0 }, n_features{ 0 };
         std::vector<int> numericFeaturesIdx;
         std::string discretizer_algorithm;
@@ -44,17 +93,54 @@ namespace platform {
         std::vector<std::string> features;
         std::vector<std::string> labels;
         std::map<std::string, std::vector<int>> states;
-        bool loaded;
+        std::atomic<bool> loaded;
+        std::mutex load_mutex;
+        std::atomic<int> pins{ 0 }; // Pin objects alive, changed holding load_mutex
+        bool tracked = false; // belongs to a shared catalog, its memory counts for the budget
+        friend class Datasets;
         bool discretize;
+        // Single copy of the data, X (n_features x n_samples) & y, owned or mapped from the binary cache
         torch::Tensor X, y;
         torch::Tensor X_train, X_test, y_train, y_test;
+        // Columns read by the text loaders, released once X & y are built
         std::vector<std::vector<float>> Xv;
         std::vector<int> yv;
+        void read();
+        void release();
+        void used();
+        size_t memorySize() const;
         void load_csv();
         void load_arff();
         void load_rdata();
         void load_csv_json();
-        void computeStates();
+        // Binary columnar cache written next to the source file or in the cache folder, see Dataset.cpp
+        std::vector<std::string> sourceFiles() const;
+        std::string cacheFile(const std::string& extension) const; // empty if the cache is disabled
+        bool load_cache(const std::string& requestedClassName);
+        void save_cache(const std::string& requestedClassName) const;
+        bool load_stats(DatasetStats& stats) const;
+        void save_stats(const DatasetStats& stats) const;
+        //
+        // Discretized folds kept by the dataset, most recently used first, until it is released
+        //
+        struct DiscretizedFold {
+            std::string key;
+            torch::Tensor X_train, X_test;
+            std::map<std::string, std::vector<int>> states;
+            size_t bytes;
+        };
+        mutable std::mutex discretization_mutex;
+        mutable std::list<DiscretizedFold> discretized_folds;
+        mutable size_t discretized_bytes = 0;
+        mutable std::atomic<bool> discretization_pruned{ false };
+        std::pair<uint64_t, uint64_t> discretizationHashes(const std::vector<int>& train, const std::vector<int>& test) const;
+        bool findDiscretized(const std::string& key, FoldTensors& fold) const;
+        void keepDiscretized(const std::string& key, const FoldTensors& fold) const;
+        bool loadDiscretized(const std::string& fileName, uint64_t data_hash, uint64_t split_hash, FoldTensors& fold) const;
+        void pruneDiscretized(const std::string& prefix, const std::string& current) const;
+        static void limitDiscretizedDisk();
+        void discretizeFold(FoldTensors& fold) const;
+        std::map<std::string, std::vector<int>> computeStates(const torch::Tensor& X_train, const torch::Tensor& X_test, const torch::Tensor& y_train, const torch::Tensor& y_test) const;
         std::vector<mdlp::labels_t> discretizeDataset(std::vector<mdlp::samples_t>& X, mdlp::labels_t& y);
     };
 };
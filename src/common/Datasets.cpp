@@ -1,6 +1,9 @@
 #include <fstream>
 #include <algorithm>
 #include <filesystem>
+#include <mutex>
+#include <tuple>
+#include <unistd.h>
 #include "Datasets.h"
 #include "DotEnv.h"
 #include <nlohmann/json.hpp>
@@ -16,6 +19,41 @@ namespace platform {
         }
         load();
     }
+    Datasets& Datasets::shared(bool discretize, const std::string& sfileType, const std::string& discretizer_algorithm)
+    {
+        static std::mutex mutex;
+        static std::map<std::tuple<std::string, bool, std::string>, std::unique_ptr<Datasets>> catalogs;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto key = std::make_tuple(sfileType, discretize, discretizer_algorithm);
+        auto item = catalogs.find(key);
+        if (item == catalogs.end()) {
+            if (catalogs.empty()) {
+                // Memory budget of the loaded datasets in MiB (0 for no limit), a quarter of the RAM by default
+                auto env = DotEnv();
+                auto budget = env.get("datasets_memory");
+                if (budget.empty()) {
+                    Dataset::setMemoryBudget(static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE) / 4);
+                } else {
+                    Dataset::setMemoryBudget(std::stoull(budget) << 20);
+                }
+                // Folder of the binary cache and statistics files of the datasets, next to the source files by default
+                Dataset::setCacheFolder(env.get("datasets_cache"));
+                // Disk cache of the discretized folds, enabled by default
+                Dataset::setDiscretizationCache(env.get("discretization_cache") != "0");
+                // MiB of discretized folds kept in memory by each dataset and MiB of the disk cache, 0 for no limit
+                auto fold_memory = env.get("discretization_memory");
+                auto fold_disk = env.get("discretization_disk");
+                Dataset::setDiscretizationLimits(fold_memory.empty() ? size_t(64) << 20 : std::stoull(fold_memory) << 20,
+                    fold_disk.empty() ? size_t(2048) << 20 : std::stoull(fold_disk) << 20);
+            }
+            auto catalog = std::make_unique<Datasets>(discretize, sfileType, discretizer_algorithm);
+            for (auto& [_, dataset] : catalog->datasets) {
+                dataset->tracked = true;
+            }
+            item = catalogs.emplace(key, std::move(catalog)).first;
+        }
+        return *item->second;
+    }
     void Datasets::load()
     {
         auto sd = SourceData(sfileType);
@@ -5,9 +5,12 @@ namespace platform {
     class Datasets {
     public:
         explicit Datasets(bool discretize, std::string sfileType, std::string discretizer_algorithm = "none");
+        // Process wide catalog of the source, parsed on first use and kept until the process ends
+        static Datasets& shared(bool discretize, const std::string& sfileType, const std::string& discretizer_algorithm = "none");
         std::vector<std::string> getNames();
         bool isDataset(const std::string& name) const;
         Dataset& getDataset(const std::string& name) const { return *datasets.at(name); }
+        DatasetStats getStats(const std::string& name) const { return datasets.at(name)->getStats(); }
         std::string toString() const;
     private:
         std::string path;
@@ -14,7 +14,7 @@ namespace platform {
     private:
         std::map<std::string, std::string> env;
         std::map<std::string, std::vector<std::string>> valid;
-        std::set<std::string> optional_keys = { "csv_json_path" };
+        std::set<std::string> optional_keys = { "csv_json_path", "result_format", "datasets_memory", "datasets_cache", "discretization_cache", "discretization_memory", "discretization_disk" };
     public:
         DotEnv(bool create = false)
         {
@@ -39,6 +39,12 @@ namespace platform {
                 {"smooth_strat", {"ORIGINAL", "LAPLACE", "CESTNIK"}},
                 {"source_data", {"Arff", "Tanveer", "Surcov", "CsvJSON", "Test"}},
                 {"csv_json_path", {"any"}},
+                {"result_format", {"json", "cbor"}},
+                {"datasets_memory", {"any"}},
+                {"datasets_cache", {"any"}},
+                {"discretization_cache", {"0", "1"}},
+                {"discretization_memory", {"any"}},
+                {"discretization_disk", {"any"}},
             };
             if (create) {
                 // For testing purposes
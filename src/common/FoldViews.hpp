@@ -0,0 +1,87 @@
+#ifndef FOLDVIEWS_HPP
+#define FOLDVIEWS_HPP
+#include <torch/torch.h>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <folding.hpp>
+namespace platform {
+    //
+    // Folds of a samples set (X is n_features x n_samples) built with a single copy.
+    // The samples are reordered once so that the test set of every fold is a contiguous
+    // block; the test tensors of a fold are then zero-copy views of the reordered data.
+    // The train tensors are the concatenation of the blocks around the test set whenever that
+    // gives the same samples order as the fold, otherwise they are gathered from the source.
+    // Only the train split of the fold being used is materialized, so callers should take each
+    // fold once and run everything that needs it before asking for the next one.
+    //
+    class FoldViews {
+    public:
+        FoldViews(folding::Fold& fold, int n_folds, const torch::Tensor& X, const torch::Tensor& y) : X(X), y(y)
+        {
+            std::vector<int> order;
+            for (int k = 0; k < n_folds; ++k) {
+                auto [train, test] = fold.getFold(k);
+                offsets.push_back(order.size());
+                order.insert(order.end(), test.begin(), test.end());
+                trains.push_back(std::move(train));
+                tests.push_back(std::move(test));
+            }
+            auto order_t = torch::tensor(order);
+            X_ordered = X.index_select(-1, order_t);
+            y_ordered = y.index_select(0, order_t);
+            for (int k = 0; k < n_folds; ++k) {
+                contiguous_train.push_back(is_rest_of(order, k));
+            }
+        }
+        int size() const { return static_cast<int>(tests.size()); }
+        const std::vector<int>& getTrainIndices(int k) const { return trains.at(k); }
+        const std::vector<int>& getTestIndices(int k) const { return tests.at(k); }
+        // Tensors of fold k: X_train, X_test, y_train, y_test
+        std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor> getFold(int k) const
+        {
+            auto start = static_cast<int64_t>(offsets.at(k));
+            auto length = static_cast<int64_t>(tests[k].size());
+            auto X_test = X_ordered.narrow(-1, start, length);
+            auto y_test = y_ordered.narrow(0, start, length);
+            torch::Tensor X_train, y_train;
+            if (contiguous_train[k]) {
+                auto end = start + length;
+                auto rest = X_ordered.size(-1) - end;
+                X_train = torch::cat({ X_ordered.narrow(-1, 0, start), X_ordered.narrow(-1, end, rest) }, -1);
+                y_train = torch::cat({ y_ordered.narrow(0, 0, start), y_ordered.narrow(0, end, rest) }, 0);
+            } else {
+                auto train_t = torch::tensor(trains[k]);
+                X_train = X.index_select(-1, train_t);
+                y_train = y.index_select(0, train_t);
+            }
+            return { X_train, X_test, y_train, y_test };
+        }
+    private:
+        // true if the train set of fold k is the reordered samples without the test block of fold k
+        bool is_rest_of(const std::vector<int>& order, int k) const
+        {
+            const auto& train = trains[k];
+            if (train.size() + tests[k].size() != order.size()) {
+                return false;
+            }
+            size_t j = 0;
+            for (size_t i = 0; i < order.size(); ++i) {
+                if (i == offsets[k] && !tests[k].empty()) {
+                    i += tests[k].size() - 1;
+                    continue;
+                }
+                if (order[i] != train[j++]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        torch::Tensor X, y;
+        torch::Tensor X_ordered, y_ordered;
+        std::vector<std::vector<int>> trains, tests;
+        std::vector<size_t> offsets;
+        std::vector<bool> contiguous_train;
+    };
+}
+#endif
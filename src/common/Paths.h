@@ -19,6 +19,7 @@ namespace platform {
         static std::string grid() { return createIfNotExists("grid/"); }
         static std::string graphs() { return createIfNotExists("graphs/"); }
         static std::string tex() { return createIfNotExists("tex/"); }
+        static std::string discretizationCache() { return createIfNotExists("disc_cache/"); }
         static std::string datasets()
         {
             auto env = platform::DotEnv();
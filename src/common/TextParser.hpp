@@ -0,0 +1,296 @@
+#ifndef TEXTPARSER_HPP
+#define TEXTPARSER_HPP
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+namespace platform {
+    //
+    // Parser of the delimited text datasets (CSV, CSV+JSON and R data) held in memory as a whole.
+    // The rows after the header are split in blocks of whole lines parsed concurrently with std::from_chars
+    // straight into the columns. Categorical values and labels get a code per block in order of appearance,
+    // the block codes are then merged in file order, so the codes are the ones of a sequential read.
+    //
+    class TextParser {
+    public:
+        struct Format {
+            char delimiter = ','; // ' ' splits on any run of blanks
+            bool row_number = false; // the rows start with the instance number (R data)
+            bool skip_invalid = false; // skip the rows with a wrong number of columns, missing or invalid values instead of throwing
+            bool numeric_labels = true; // the label is the integer in the last column, otherwise its code
+            size_t blocks = 0; // blocks parsed concurrently, 0 chooses them from the size and the hardware threads
+        };
+        TextParser(const char* data, size_t size, Format format) : begin(data), end(data + size), format(format)
+        {
+            auto eol = static_cast<const char*>(std::memchr(begin, '\n', size));
+            body = eol == nullptr ? end : eol + 1;
+        }
+        // Tokens of the first line
+        std::vector<std::string> header() const
+        {
+            std::vector<std::string_view> tokens;
+            split(begin, body, tokens);
+            return std::vector<std::string>(tokens.begin(), tokens.end());
+        }
+        // Parses the rows. categorical[i] tells if the feature i is factorized instead of read as a number.
+        // labels gets the distinct labels in order of appearance
+        void parse(const std::vector<bool>& categorical, std::vector<std::vector<float>>& X, std::vector<int>& y, std::vector<std::string>& labels) const
+        {
+            auto blocks = make_blocks();
+            size_t rows = 0;
+            for (auto& block : blocks) {
+                block.first_row = rows;
+                rows += block.lines;
+            }
+            X.assign(categorical.size(), std::vector<float>(rows));
+            y.assign(rows, 0);
+            run(blocks, [&](Block& block) { parse_block(block, categorical, X, y); });
+            size_t line = 2; // the header is line 1
+            for (const auto& block : blocks) {
+                if (block.error) {
+                    try {
+                        std::rethrow_exception(block.error);
+                    }
+                    catch (const std::out_of_range& e) {
+                        throw std::out_of_range(std::string(e.what()) + " in line " + std::to_string(line + block.error_line));
+                    }
+                    catch (const std::invalid_argument& e) {
+                        throw std::invalid_argument(std::string(e.what()) + " in line " + std::to_string(line + block.error_line));
+                    }
+                }
+                line += block.lines;
+            }
+            //
+            // Merge the codes of the blocks in file order and translate the ones written by each block
+            //
+            std::vector<Factorizer> global(categorical.size() + 1);
+            for (auto& block : blocks) {
+                block.remap.resize(global.size());
+                for (size_t f = 0; f < global.size(); ++f) {
+                    for (const auto& value : block.factors[f].values) {
+                        block.remap[f].push_back(global[f].code(value));
+                    }
+                }
+            }
+            run(blocks, [&](Block& block) {
+                for (size_t f = 0; f < categorical.size(); ++f) {
+                    if (!categorical[f])
+                        continue;
+                    auto column = X[f].data() + block.first_row;
+                    for (size_t r = 0; r < block.rows; ++r) {
+                        column[r] = static_cast<float>(block.remap[f][static_cast<int>(column[r])]);
+                    }
+                }
+                if (!format.numeric_labels) {
+                    auto column = y.data() + block.first_row;
+                    for (size_t r = 0; r < block.rows; ++r) {
+                        column[r] = block.remap.back()[column[r]];
+                    }
+                }
+                });
+            //
+            // Close the gaps left by the skipped rows
+            //
+            size_t target = 0;
+            for (const auto& block : blocks) {
+                if (target != block.first_row) {
+                    for (auto& column : X) {
+                        std::memmove(column.data() + target, column.data() + block.first_row, block.rows * sizeof(float));
+                    }
+                    std::memmove(y.data() + target, y.data() + block.first_row, block.rows * sizeof(int));
+                }
+                target += block.rows;
+            }
+            for (auto& column : X) {
+                column.resize(target);
+            }
+            y.resize(target);
+            labels.assign(global.back().values.begin(), global.back().values.end());
+        }
+    private:
+        // Codes of the distinct values in order of appearance
+        struct Factorizer {
+            std::unordered_map<std::string_view, int> codes;
+            std::vector<std::string_view> values;
+            int code(std::string_view value)
+            {
+                auto [item, inserted] = codes.try_emplace(value, static_cast<int>(values.size()));
+                if (inserted)
+                    values.push_back(value);
+                return item->second;
+            }
+        };
+        struct Block {
+            const char* begin;
+            const char* end;
+            size_t lines = 0; // rows reserved for the block, one per line
+            size_t first_row = 0;
+            size_t rows = 0; // rows written
+            std::vector<Factorizer> factors; // one per feature plus the label
+            std::vector<std::vector<int>> remap;
+            std::exception_ptr error;
+            size_t error_line = 0;
+        };
+        static bool is_blank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+        }
+        // Splits a line in trimmed tokens
+        void split(const char* first, const char* last, std::vector<std::string_view>& tokens) const
+        {
+            tokens.clear();
+            if (format.delimiter == ' ') {
+                while (first < last) {
+                    while (first < last && is_blank(*first)) ++first;
+                    auto start = first;
+                    while (first < last && !is_blank(*first)) ++first;
+                    if (first > start)
+                        tokens.emplace_back(start, first - start);
+                }
+                return;
+            }
+            while (true) {
+                auto next = static_cast<const char*>(std::memchr(first, format.delimiter, last - first));
+                auto token_end = next == nullptr ? last : next;
+                auto start = first;
+                while (start < token_end && is_blank(*start)) ++start;
+                while (token_end > start && is_blank(*(token_end - 1))) --token_end;
+                tokens.emplace_back(start, token_end - start);
+                if (next == nullptr)
+                    break;
+                first = next + 1;
+            }
+        }
+        // As stof and stoi, reads the number at the start of the token
+        template<typename T>
+        static std::errc read(std::string_view token, T& value)
+        {
+            auto first = token.data();
+            auto last = first + token.size();
+            if (first != last && *first == '+')
+                ++first;
+            return std::from_chars(first, last, value).ec;
+        }
+        std::vector<Block> make_blocks() const
+        {
+            const size_t min_block = 1 << 20;
+            size_t size = end - body;
+            size_t n_blocks = format.blocks;
+            if (n_blocks == 0)
+                n_blocks = std::max<size_t>(1, std::min<size_t>(size / min_block, std::max(1u, std::thread::hardware_concurrency())));
+            std::vector<Block> blocks;
+            auto start = body;
+            for (size_t b = 1; b <= n_blocks && start < end; ++b) {
+                auto stop = b == n_blocks ? end : std::max(start, body + b * (size / n_blocks));
+                if (stop < end) {
+                    auto eol = static_cast<const char*>(std::memchr(stop, '\n', end - stop));
+                    stop = eol == nullptr ? end : eol + 1;
+                }
+                Block block;
+                block.begin = start;
+                block.end = stop;
+                blocks.push_back(std::move(block));
+                start = stop;
+            }
+            run(blocks, [](Block& block) {
+                block.lines = std::count(block.begin, block.end, '\n');
+                if (block.end > block.begin && *(block.end - 1) != '\n')
+                    block.lines++;
+                });
+            return blocks;
+        }
+        template<typename Body>
+        static void run(std::vector<Block>& blocks, Body body)
+        {
+            std::vector<std::thread> workers;
+            for (size_t b = 1; b < blocks.size(); ++b) {
+                workers.emplace_back([&body, &blocks, b]() { body(blocks[b]); });
+            }
+            if (!blocks.empty())
+                body(blocks[0]);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        void parse_block(Block& block, const std::vector<bool>& categorical, std::vector<std::vector<float>>& X, std::vector<int>& y) const
+        {
+            auto n_features = categorical.size();
+            size_t offset = format.row_number ? 1 : 0;
+            size_t expected = n_features + offset + 1;
+            block.factors.resize(n_features + 1);
+            std::vector<std::string_view> tokens;
+            std::vector<float> row(n_features);
+            auto first = block.begin;
+            for (size_t line = 0; first < block.end; ++line) {
+                auto eol = static_cast<const char*>(std::memchr(first, '\n', block.end - first));
+                auto last = eol == nullptr ? block.end : eol;
+                auto line_begin = first;
+                first = last + 1;
+                if (std::all_of(line_begin, last, is_blank))
+                    continue;
+                split(line_begin, last, tokens);
+                try {
+                    if (tokens.size() != expected) {
+                        if (format.skip_invalid)
+                            continue;
+                        if (tokens.size() < expected)
+                            throw std::invalid_argument("Wrong number of columns");
+                    }
+                    if (format.skip_invalid && std::any_of(tokens.begin(), tokens.end(), [](const auto& token) { return token.empty(); }))
+                        continue;
+                    bool invalid = false;
+                    for (size_t i = 0; i < n_features && !invalid; ++i) {
+                        if (categorical[i])
+                            continue;
+                        const auto& token = tokens[i + offset];
+                        auto ec = read(token, row[i]);
+                        if (ec == std::errc::result_out_of_range)
+                            throw std::out_of_range("Value out of range: " + std::string(token));
+                        if (ec != std::errc()) {
+                            if (!format.skip_invalid)
+                                throw std::invalid_argument("Invalid value: " + std::string(token));
+                            invalid = true;
+                        }
+                    }
+                    if (invalid)
+                        continue;
+                    // Values of the rows kept only, so the skipped ones leave no unused codes
+                    for (size_t i = 0; i < n_features; ++i) {
+                        if (categorical[i])
+                            row[i] = static_cast<float>(block.factors[i].code(tokens[i + offset]));
+                    }
+                    const auto& label = tokens.back();
+                    int value = block.factors[n_features].code(label);
+                    if (format.numeric_labels) {
+                        auto ec = read(label, value);
+                        if (ec == std::errc::result_out_of_range)
+                            throw std::out_of_range("Label out of range: " + std::string(label));
+                        if (ec != std::errc())
+                            throw std::invalid_argument("Invalid label: " + std::string(label));
+                    }
+                    auto r = block.first_row + block.rows++;
+                    for (size_t i = 0; i < n_features; ++i) {
+                        X[i][r] = row[i];
+                    }
+                    y[r] = value;
+                }
+                catch (...) {
+                    block.error = std::current_exception();
+                    block.error_line = line;
+                    return;
+                }
+            }
+        }
+        const char* begin;
+        const char* end;
+        const char* body; // first row after the header
+        Format format;
+    };
+}
+#endif
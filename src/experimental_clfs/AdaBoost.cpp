@@ -12,6 +12,10 @@
 #include <sstream>
 #include <iomanip>
 #include "common/TensorUtils.hpp"
+#include "ThreadPool.hpp"
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 // Conditional debug macro for performance-critical sections
 #define DEBUG_LOG(condition, ...) \
@@ -22,6 +26,36 @@
     } while(0)
 
 namespace bayesnet {
+    // Samples evaluated together by each inference task
+    const int inference_block = 256;
+
+    // classes[i] = x[i] == value ? class_left : class_right
+    static inline void select_classes(const int* x, int n, int value, int class_left, int class_right, int* classes)
+    {
+        int i = 0;
+#if defined(__AVX512F__)
+        auto value16 = _mm512_set1_epi32(value);
+        auto left16 = _mm512_set1_epi32(class_left);
+        auto right16 = _mm512_set1_epi32(class_right);
+        for (; i + 16 <= n; i += 16) {
+            auto mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(x + i), value16);
+            _mm512_storeu_si512(classes + i, _mm512_mask_blend_epi32(mask, right16, left16));
+        }
+#endif
+#if defined(__AVX2__)
+        auto value8 = _mm256_set1_epi32(value);
+        auto left8 = _mm256_set1_epi32(class_left);
+        auto right8 = _mm256_set1_epi32(class_right);
+        for (; i + 8 <= n; i += 8) {
+            auto mask = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)), value8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(classes + i), _mm256_blendv_epi8(right8, left8, mask));
+        }
+#endif
+        for (; i < n; ++i) {
+            classes[i] = x[i] == value ? class_left : class_right;
+        }
+    }
+
 
     AdaBoost::AdaBoost(int n_estimators, int max_depth)
         : Ensemble(true), n_estimators(n_estimators), base_max_depth(max_depth), n(0), n_classes(0)
@@ -44,17 +78,24 @@ namespace bayesnet {
 
         // Initialize sample weights uniformly
         int n_samples = dataset.size(1);
-        sample_weights = torch::ones({ n_samples }) / n_samples;
+        sample_weights.assign(n_samples, 1.0 / n_samples);
 
         // If initial weights are provided, incorporate them
         if (weights.defined() && weights.numel() > 0) {
             if (weights.size(0) != n_samples) {
                 throw std::runtime_error("weights must have the same length as number of samples");
             }
-            sample_weights = weights.clone();
+            auto initial = weights.to(torch::kDouble).contiguous();
+            sample_weights.assign(initial.data_ptr<double>(), initial.data_ptr<double>() + n_samples);
             normalizeWeights();
         }
 
+        // Training data is sliced once and every estimator predicts it only once
+        X_train = dataset.index({ torch::indexing::Slice(0, dataset.size(0) - 1), torch::indexing::Slice() }).to(torch::kInt32).contiguous();
+        auto y_data = dataset.index({ -1, torch::indexing::Slice() }).to(torch::kInt32).contiguous();
+        y_train.assign(y_data.data_ptr<int>(), y_data.data_ptr<int>() + n_samples);
+        std::vector<char> incorrect(n_samples);
+
         // Conditional debug information (only when debug is enabled)
         DEBUG_LOG(debug, "Starting AdaBoost training with " << n_estimators << " estimators\n"
             << "Number of classes: " << n_classes << "\n"
@@ -67,10 +108,11 @@ namespace bayesnet {
         // Main AdaBoost training loop (SAMME algorithm)
         for (int iter = 0; iter < n_estimators; ++iter) {
             // Train base estimator with current sample weights
-            auto estimator = trainBaseEstimator(sample_weights);
+            auto estimator = trainBaseEstimator(torch::from_blob(sample_weights.data(), { n_samples }, torch::kDouble));
 
             // Calculate weighted error
-            double weighted_error = calculateWeightedError(estimator.get(), sample_weights);
+            trainPredictions(estimator.get(), incorrect);
+            double weighted_error = calculateWeightedError(incorrect);
             training_errors.push_back(weighted_error);
 
             // According to SAMME, we need error < random_guess_error
@@ -119,8 +161,7 @@ namespace bayesnet {
 
             // Update sample weights (only if this is not the last iteration)
             if (iter < n_estimators - 1) {
-                updateSampleWeights(models.back().get(), alpha);
-                normalizeWeights();
+                updateSampleWeights(incorrect, alpha);
             }
 
             DEBUG_LOG(debug, "Iteration " << iter << ":\n"
@@ -129,8 +170,13 @@ namespace bayesnet {
                 << "  Random guess error: " << random_guess_error);
         }
 
+        // Release the training data copies
+        X_train = torch::Tensor();
+        y_train.clear();
+
         // Set the number of models actually trained
         n_models = models.size();
+        compileEnsemble();
         DEBUG_LOG(debug, "AdaBoost training completed with " << n_models << " models");
     }
 
@@ -155,61 +201,66 @@ namespace bayesnet {
         return tree;
     }
 
-    double AdaBoost::calculateWeightedError(Classifier* estimator, const torch::Tensor& weights)
+    void AdaBoost::trainPredictions(Classifier* estimator, std::vector<char>& incorrect) const
     {
-        // Get features and labels from dataset (avoid repeated indexing)
-        auto X = dataset.index({ torch::indexing::Slice(0, dataset.size(0) - 1), torch::indexing::Slice() });
-        auto y_true = dataset.index({ -1, torch::indexing::Slice() });
-
-        // Get predictions from the estimator
-        auto y_pred = estimator->predict(X);
-
-        // Vectorized error calculation using PyTorch operations
-        auto incorrect = (y_pred != y_true).to(torch::kDouble);
+        const int n_samples = y_train.size();
+        std::vector<int> leaves(n_samples);
+        auto tree = static_cast<DecisionTree*>(estimator);
+        tree->predictLeaves(X_train.data_ptr<int>(), n_samples, leaves.data());
+        for (int i = 0; i < n_samples; ++i) {
+            incorrect[i] = tree->leafClass(leaves[i]) != y_train[i];
+        }
+    }
 
-        // Direct dot product for weighted error (more efficient than sum)
-        double weighted_error = torch::dot(incorrect, weights).item<double>();
+    double AdaBoost::calculateWeightedError(const std::vector<char>& incorrect) const
+    {
+        double weighted_error = 0.0;
+        for (size_t i = 0; i < incorrect.size(); ++i) {
+            if (incorrect[i]) {
+                weighted_error += sample_weights[i];
+            }
+        }
 
         // Clamp to valid range in one operation
         return std::clamp(weighted_error, 1e-15, 1.0 - 1e-15);
     }
 
-    void AdaBoost::updateSampleWeights(Classifier* estimator, double alpha)
+    void AdaBoost::updateSampleWeights(const std::vector<char>& incorrect, double alpha)
     {
-        // Get predictions from the estimator (reuse from calculateWeightedError if possible)
-        auto X = dataset.index({ torch::indexing::Slice(0, dataset.size(0) - 1), torch::indexing::Slice() });
-        auto y_true = dataset.index({ -1, torch::indexing::Slice() });
-        auto y_pred = estimator->predict(X);
-
-        // Vectorized weight update using PyTorch operations
-        auto incorrect = (y_pred != y_true).to(torch::kDouble);
-
-        // Single vectorized operation instead of element-wise multiplication
-        sample_weights *= torch::exp(alpha * incorrect);
-
-        // Vectorized clamping for numerical stability
-        sample_weights = torch::clamp(sample_weights, 1e-15, 1e15);
+        // Boost the misclassified samples, clamp for numerical stability and normalize
+        const double factor = std::exp(alpha);
+        double sum_weights = 0.0;
+        for (size_t i = 0; i < sample_weights.size(); ++i) {
+            double weight = incorrect[i] ? sample_weights[i] * factor : sample_weights[i];
+            weight = std::clamp(weight, 1e-15, 1e15);
+            sample_weights[i] = weight;
+            sum_weights += weight;
+        }
+        normalizeWeights(sum_weights);
     }
 
     void AdaBoost::normalizeWeights()
     {
-        // Single-pass normalization using PyTorch operations
-        double sum_weights = torch::sum(sample_weights).item<double>();
+        normalizeWeights(std::accumulate(sample_weights.begin(), sample_weights.end(), 0.0));
+    }
 
+    void AdaBoost::normalizeWeights(double sum_weights)
+    {
         if (__builtin_expect(sum_weights <= 0, 0)) {
             // Reset to uniform if all weights are zero/negative (rare case)
-            sample_weights = torch::ones_like(sample_weights) / sample_weights.size(0);
-        } else {
-            // Vectorized normalization
-            sample_weights /= sum_weights;
-
-            // Vectorized minimum weight enforcement
-            sample_weights = torch::clamp_min(sample_weights, 1e-15);
-
-            // Renormalize after clamping (if any weights were clamped)
-            double new_sum = torch::sum(sample_weights).item<double>();
-            if (new_sum != 1.0) {
-                sample_weights /= new_sum;
+            std::fill(sample_weights.begin(), sample_weights.end(), 1.0 / sample_weights.size());
+            return;
+        }
+        // Normalize enforcing a minimum weight
+        double new_sum = 0.0;
+        for (auto& weight : sample_weights) {
+            weight = std::max(weight / sum_weights, 1e-15);
+            new_sum += weight;
+        }
+        // Renormalize after clamping (if any weights were clamped)
+        if (new_sum != 1.0) {
+            for (auto& weight : sample_weights) {
+                weight /= new_sum;
             }
         }
     }
@@ -384,7 +435,57 @@ namespace bayesnet {
         return class_probs;
     }
 
-    torch::Tensor AdaBoost::predict_proba(torch::Tensor& X)
+    void AdaBoost::compileEnsemble()
+    {
+        compiled = CompiledEnsemble();
+        for (size_t i = 0; i < models.size(); ++i) {
+            double alpha = alphas[i];
+            if (alpha <= 0 || !std::isfinite(alpha)) continue;
+            auto tree = static_cast<const DecisionTree*>(models[i].get());
+            int feature = 0, value = 0, class_left = 0, class_right = 0;
+            bool stump = tree->asStump(feature, value, class_left, class_right);
+            compiled.feature.push_back(feature);
+            compiled.value.push_back(value);
+            compiled.class_left.push_back(class_left >= 0 && class_left < n_classes ? class_left : n_classes);
+            compiled.class_right.push_back(class_right >= 0 && class_right < n_classes ? class_right : n_classes);
+            compiled.alpha.push_back(alpha);
+            compiled.tree.push_back(stump ? nullptr : tree);
+        }
+    }
+
+    void AdaBoost::accumulateVotes(const int* X, long stride, int begin, int end, std::vector<double>& votes, std::vector<double>& totals) const
+    {
+        const int n_samples = end - begin;
+        const int width = n_classes + 1;
+        votes.assign(static_cast<size_t>(n_samples) * width, 0.0);
+        totals.assign(n_samples, 0.0);
+        std::vector<int> classes(n_samples);
+        std::vector<int> leaves;
+        // Estimators are applied in model order so every sum is accumulated as in predictProbaSample
+        for (size_t k = 0; k < compiled.alpha.size(); ++k) {
+            auto tree = compiled.tree[k];
+            if (tree == nullptr) {
+                select_classes(X + compiled.feature[k] * stride + begin, n_samples, compiled.value[k],
+                    compiled.class_left[k], compiled.class_right[k], classes.data());
+            } else {
+                leaves.resize(n_samples);
+                tree->predictLeaves(X + begin, n_samples, stride, leaves.data());
+                for (int i = 0; i < n_samples; ++i) {
+                    int predicted_class = tree->leafClass(leaves[i]);
+                    classes[i] = predicted_class >= 0 && predicted_class < n_classes ? predicted_class : n_classes;
+                }
+            }
+            const double alpha = compiled.alpha[k];
+            for (int i = 0; i < n_samples; ++i) {
+                votes[i * width + classes[i]] += alpha;
+                if (classes[i] < n_classes) {
+                    totals[i] += alpha;
+                }
+            }
+        }
+    }
+
+    torch::Tensor AdaBoost::toFeatureMatrix(const torch::Tensor& X) const
     {
         if (!fitted || models.empty()) {
             throw std::runtime_error(CLASSIFIER_NOT_FITTED);
@@ -395,26 +496,38 @@ namespace bayesnet {
             throw std::runtime_error("Input has wrong number of features. Expected " +
                 std::to_string(n) + " but got " + std::to_string(X.size(0)));
         }
+        return X.to(torch::kInt32).contiguous();
+    }
 
+    torch::Tensor AdaBoost::predict_proba(torch::Tensor& X)
+    {
+        auto X_data = toFeatureMatrix(X);
         const int n_samples = X.size(1);
 
         // Pre-allocate output tensor with correct layout
         torch::Tensor probabilities = torch::empty({ n_samples, n_classes },
             torch::TensorOptions().dtype(torch::kFloat32));
-
-        // Convert to contiguous memory if needed (optimization for memory access)
-        if (!X.is_contiguous()) {
-            X = X.contiguous();
-        }
-
-        // Batch processing with memory-efficient sample extraction
-        for (int i = 0; i < n_samples; ++i) {
-            // Extract sample without unnecessary copies
-            auto sample = X.select(1, i);
-
-            // Direct assignment to pre-allocated tensor
-            probabilities[i] = predictProbaSample(sample);
-        }
+        const int* X_ptr = X_data.data_ptr<int>();
+        float* probs_ptr = probabilities.data_ptr<float>();
+
+        // Blocks of samples are evaluated in parallel against the whole ensemble
+        ThreadPool::getInstance().parallel_for(0, n_samples, inference_block, [&](int begin, int end) {
+            std::vector<double> votes, totals;
+            accumulateVotes(X_ptr, n_samples, begin, end, votes, totals);
+            const int width = n_classes + 1;
+            for (int i = 0; i < end - begin; ++i) {
+                float* row = probs_ptr + static_cast<long>(begin + i) * n_classes;
+                if (__builtin_expect(totals[i] > 0.0, 1)) {
+                    const double inv_total = 1.0 / totals[i];
+                    for (int j = 0; j < n_classes; ++j) {
+                        row[j] = static_cast<float>(votes[i * width + j] * inv_total);
+                    }
+                } else {
+                    // Uniform distribution fallback
+                    std::fill_n(row, n_classes, 1.0f / n_classes);
+                }
+            }
+            });
 
         return probabilities;
     }
@@ -449,31 +562,23 @@ namespace bayesnet {
 
     torch::Tensor AdaBoost::predict(torch::Tensor& X)
     {
-        if (!fitted || models.empty()) {
-            throw std::runtime_error(CLASSIFIER_NOT_FITTED);
-        }
-
-        if (X.size(0) != n) {
-            throw std::runtime_error("Input has wrong number of features. Expected " +
-                std::to_string(n) + " but got " + std::to_string(X.size(0)));
-        }
-
+        auto X_data = toFeatureMatrix(X);
         const int n_samples = X.size(1);
 
         // Pre-allocate with correct dtype
         torch::Tensor predictions = torch::empty({ n_samples }, torch::TensorOptions().dtype(torch::kInt32));
-        auto pred_accessor = predictions.accessor<int32_t, 1>();
-
-        // Ensure contiguous memory layout
-        if (!X.is_contiguous()) {
-            X = X.contiguous();
-        }
-
-        // Optimized prediction loop
-        for (int i = 0; i < n_samples; ++i) {
-            auto sample = X.select(1, i);
-            pred_accessor[i] = predictSample(sample);
-        }
+        const int* X_ptr = X_data.data_ptr<int>();
+        int* pred_ptr = predictions.data_ptr<int>();
+
+        ThreadPool::getInstance().parallel_for(0, n_samples, inference_block, [&](int begin, int end) {
+            std::vector<double> votes, totals;
+            accumulateVotes(X_ptr, n_samples, begin, end, votes, totals);
+            const int width = n_classes + 1;
+            for (int i = 0; i < end - begin; ++i) {
+                const double* row = votes.data() + i * width;
+                pred_ptr[begin + i] = std::distance(row, std::max_element(row, row + n_classes));
+            }
+            });
 
         return predictions;
     }
@@ -12,6 +12,7 @@
 #include "bayesnet/ensembles/Ensemble.h"
 
 namespace bayesnet {
+    class DecisionTree;
     class AdaBoost : public Ensemble {
     public:
         explicit AdaBoost(int n_estimators = 100, int max_depth = 1);
@@ -50,25 +51,52 @@ namespace bayesnet {
         int base_max_depth;  // Max depth for base decision trees
         std::vector<double> alphas;  // Weight of each base estimator
         std::vector<double> training_errors;  // Training error at each iteration
-        torch::Tensor sample_weights;  // Current sample weights
+        std::vector<double> sample_weights;  // Current sample weights, double as the weights fit receives (summed sequentially)
+        // Contiguous copies of the training data, taken once per fit
+        torch::Tensor X_train;  // n x n_samples int32
+        std::vector<int> y_train;
         int n_classes;  // Number of classes in the target variable
         int n;  // Number of features
 
         // Train a single base estimator
         std::unique_ptr<Classifier> trainBaseEstimator(const torch::Tensor& weights);
 
+        // Predict the training samples once with a new estimator, marking the misclassified ones
+        void trainPredictions(Classifier* estimator, std::vector<char>& incorrect) const;
+
         // Calculate weighted error
-        double calculateWeightedError(Classifier* estimator, const torch::Tensor& weights);
+        double calculateWeightedError(const std::vector<char>& incorrect) const;
 
-        // Update sample weights based on predictions
-        void updateSampleWeights(Classifier* estimator, double alpha);
+        // Update and normalize sample weights based on the misclassified samples
+        void updateSampleWeights(const std::vector<char>& incorrect, double alpha);
 
         // Normalize weights to sum to 1
         void normalizeWeights();
+        void normalizeWeights(double sum_weights);
 
         // Check if hyperparameters values are valid
         void checkValues() const;
 
+        // Voting estimators (alpha > 0 and finite) in model order, compiled for batched inference.
+        // Stumps are applied from the (feature, value, class_left, class_right, alpha) tables and
+        // deeper trees (tree[i] != nullptr) through DecisionTree::predictLeaves
+        struct CompiledEnsemble {
+            std::vector<int> feature;
+            std::vector<int> value;
+            std::vector<int> class_left;   // n_classes if the class is out of range
+            std::vector<int> class_right;
+            std::vector<double> alpha;
+            std::vector<const DecisionTree*> tree;
+        };
+        CompiledEnsemble compiled;
+        void compileEnsemble();
+        // Weighted votes of the samples [begin, end) of X (n x stride int32, one row per feature)
+        // in votes ((end - begin) x (n_classes + 1), last column for out of range classes) and
+        // the sum of the weights of the valid votes of each sample in totals
+        void accumulateVotes(const int* X, long stride, int begin, int end, std::vector<double>& votes, std::vector<double>& totals) const;
+        // Checks and converts X to a contiguous n x n_samples int32 matrix
+        torch::Tensor toFeatureMatrix(const torch::Tensor& X) const;
+
         // Make predictions for a single sample
         int predictSample(const torch::Tensor& x) const;
 
@@ -85,6 +85,7 @@ namespace bayesnet {
 
         // Build the tree
         root = buildTree(X, y, sample_weights, 0);
+        flattenTree();
 
         // Mark as fitted
         fitted = true;
@@ -121,15 +122,7 @@ namespace bayesnet {
             node->is_leaf = true;
 
             // Calculate class probabilities
-            node->class_probabilities = torch::zeros({ n_classes });
-
-            for (int i = 0; i < n_samples; i++) {
-                int class_idx = y[i].item<int>();
-                node->class_probabilities[class_idx] += sample_weights[i].item<float>();
-            }
-
-            // Normalize probabilities
-            node->class_probabilities /= node->class_probabilities.sum();
+            node->class_probabilities = classProbabilities(y, sample_weights);
 
             // Set predicted class as the one with highest probability
             node->predicted_class = torch::argmax(node->class_probabilities).item<int>();
@@ -145,14 +138,7 @@ namespace bayesnet {
             node->is_leaf = true;
 
             // Calculate class probabilities
-            node->class_probabilities = torch::zeros({ n_classes });
-
-            for (int i = 0; i < n_samples; i++) {
-                int class_idx = y[i].item<int>();
-                node->class_probabilities[class_idx] += sample_weights[i].item<float>();
-            }
-
-            node->class_probabilities /= node->class_probabilities.sum();
+            node->class_probabilities = classProbabilities(y, sample_weights);
             node->predicted_class = torch::argmax(node->class_probabilities).item<int>();
 
             return node;
@@ -214,41 +200,89 @@ namespace bayesnet {
         int n_features = X.size(1);
         int n_samples = X.size(0);
 
+        // Work on plain arrays: X is n_samples x n_features
+        auto X_data = X.to(torch::kInt32).contiguous();
+        auto y_data = y.to(torch::kInt32).contiguous();
+        auto w_data = sample_weights.to(torch::kFloat32).contiguous();
+        const int* X_ptr = X_data.data_ptr<int>();
+        const int* y_ptr = y_data.data_ptr<int>();
+        const float* w_ptr = w_data.data_ptr<float>();
+
         // Calculate impurity of current node
-        double current_impurity = calculateGiniImpurity(y, sample_weights);
-        double total_weight = sample_weights.sum().item<double>();
+        std::vector<double> node_weights(n_classes, 0.0);
+        for (int i = 0; i < n_samples; i++) {
+            if (y_ptr[i] < 0 || y_ptr[i] >= n_classes) {
+                throw std::runtime_error("Invalid class index: " + std::to_string(y_ptr[i]));
+            }
+            node_weights[y_ptr[i]] += w_ptr[i];
+        }
+        double current_impurity = giniImpurity(node_weights.data());
+        double total_weight = std::accumulate(node_weights.begin(), node_weights.end(), 0.0);
 
-        // Try each feature
+        // Per feature histograms of (value x class) weights and value counts
+        std::vector<double> histogram, left_weights(n_classes), right_weights(n_classes);
+        std::vector<double> prefix, suffix;
+        std::vector<int> counts, values(n_samples);
         for (int feat_idx = 0; feat_idx < n_features; feat_idx++) {
-            auto feature_values = X.index({ torch::indexing::Slice(), feat_idx });
-            auto unique_values = std::get<0>(torch::unique_consecutive(std::get<0>(torch::sort(feature_values))));
-
-            // Try each unique value as split point
-            for (int i = 0; i < unique_values.size(0); i++) {
-                int split_val = unique_values[i].item<int>();
-
-                // Create masks for left and right splits
-                auto left_mask = feature_values == split_val;
-                auto right_mask = ~left_mask;
-
-                int left_count = left_mask.sum().item<int>();
-                int right_count = right_mask.sum().item<int>();
+            for (int i = 0; i < n_samples; i++) {
+                values[i] = X_ptr[i * n_features + feat_idx];
+            }
+            auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+            int min_value = *min_it;
+            long range = static_cast<long>(*max_it) - min_value + 1;
+            // Dense histogram over [min, max] or, for sparse values, over the sorted unique values
+            std::vector<int> unique_values;
+            if (range > std::max(1024L, 2L * n_samples)) {
+                unique_values = values;
+                std::sort(unique_values.begin(), unique_values.end());
+                unique_values.erase(std::unique(unique_values.begin(), unique_values.end()), unique_values.end());
+                range = unique_values.size();
+            }
+            auto bin = [&](int value) {
+                if (unique_values.empty())
+                    return static_cast<long>(value - min_value);
+                return static_cast<long>(std::lower_bound(unique_values.begin(), unique_values.end(), value) - unique_values.begin());
+                };
+            histogram.assign(range * n_classes, 0.0);
+            counts.assign(range, 0);
+            for (int i = 0; i < n_samples; i++) {
+                auto b = bin(values[i]);
+                histogram[b * n_classes + y_ptr[i]] += w_ptr[i];
+                counts[b]++;
+            }
+            // prefix[b] = weights of bins before b, suffix[b] = weights of bins after b, per class
+            prefix.assign((range + 1) * n_classes, 0.0);
+            suffix.assign((range + 1) * n_classes, 0.0);
+            for (long b = 0; b < range; b++) {
+                for (int c = 0; c < n_classes; c++) {
+                    prefix[(b + 1) * n_classes + c] = prefix[b * n_classes + c] + histogram[b * n_classes + c];
+                }
+            }
+            for (long b = range - 1; b >= 0; b--) {
+                for (int c = 0; c < n_classes; c++) {
+                    suffix[b * n_classes + c] = suffix[(b + 1) * n_classes + c] + histogram[b * n_classes + c];
+                }
+            }
+            // Try each present value as split point: value == split goes left
+            for (long b = 0; b < range; b++) {
+                int left_count = counts[b];
+                if (left_count == 0) {
+                    continue;
+                }
+                int right_count = n_samples - left_count;
 
                 // Skip if split doesn't satisfy minimum samples requirement
                 if (left_count < min_samples_leaf || right_count < min_samples_leaf) {
                     continue;
                 }
-
-                // Calculate weighted impurities
-                auto left_y = y.index({ left_mask });
-                auto left_weights = sample_weights.index({ left_mask });
-                double left_weight = left_weights.sum().item<double>();
-                double left_impurity = calculateGiniImpurity(left_y, left_weights);
-
-                auto right_y = y.index({ right_mask });
-                auto right_weights = sample_weights.index({ right_mask });
-                double right_weight = right_weights.sum().item<double>();
-                double right_impurity = calculateGiniImpurity(right_y, right_weights);
+                for (int c = 0; c < n_classes; c++) {
+                    left_weights[c] = histogram[b * n_classes + c];
+                    right_weights[c] = prefix[b * n_classes + c] + suffix[(b + 1) * n_classes + c];
+                }
+                double left_weight = std::accumulate(left_weights.begin(), left_weights.end(), 0.0);
+                double right_weight = std::accumulate(right_weights.begin(), right_weights.end(), 0.0);
+                double left_impurity = giniImpurity(left_weights.data());
+                double right_impurity = giniImpurity(right_weights.data());
 
                 // Calculate impurity decrease
                 double impurity_decrease = current_impurity -
@@ -258,73 +292,163 @@ namespace bayesnet {
                 // Update best split if this is better
                 if (impurity_decrease > best_split.impurity_decrease) {
                     best_split.feature_index = feat_idx;
-                    best_split.split_value = split_val;
+                    best_split.split_value = unique_values.empty() ? static_cast<int>(b + min_value) : unique_values[b];
                     best_split.impurity_decrease = impurity_decrease;
-                    best_split.left_mask = left_mask;
-                    best_split.right_mask = right_mask;
                 }
             }
         }
-
+        if (best_split.feature_index != -1) {
+            best_split.left_mask = X.index({ torch::indexing::Slice(), best_split.feature_index }) == best_split.split_value;
+            best_split.right_mask = ~best_split.left_mask;
+        }
         return best_split;
     }
 
-    double DecisionTree::calculateGiniImpurity(
-        const torch::Tensor& y,
-        const torch::Tensor& sample_weights)
+    torch::Tensor DecisionTree::classProbabilities(const torch::Tensor& y, const torch::Tensor& sample_weights) const
     {
-        if (y.size(0) == 0 || sample_weights.size(0) == 0) {
-            return 0.0;
-        }
-
-        if (y.size(0) != sample_weights.size(0)) {
-            throw std::runtime_error("y and sample_weights must have same size");
-        }
-
-        torch::Tensor class_weights = torch::zeros({ n_classes });
-
-        // Calculate weighted class counts
-        for (int i = 0; i < y.size(0); i++) {
-            int class_idx = y[i].item<int>();
-
-            if (class_idx < 0 || class_idx >= n_classes) {
-                throw std::runtime_error("Invalid class index: " + std::to_string(class_idx));
-            }
-
-            class_weights[class_idx] += sample_weights[i].item<float>();
+        // Class histogram over the raw arrays, accumulated in float in the samples order
+        auto y_data = y.to(torch::kInt32).contiguous();
+        auto w_data = sample_weights.to(torch::kFloat32).contiguous();
+        const int* y_ptr = y_data.data_ptr<int>();
+        const float* w_ptr = w_data.data_ptr<float>();
+        std::vector<float> histogram(n_classes, 0.0f);
+        for (int i = 0; i < y_data.size(0); i++) {
+            histogram[y_ptr[i]] += w_ptr[i];
+        }
+        auto probabilities = torch::tensor(histogram, torch::kFloat32);
+        return probabilities / probabilities.sum();
+    }
+    double DecisionTree::giniImpurity(const double* class_weights) const
+    {
+        double total_weight = 0.0;
+        for (int i = 0; i < n_classes; i++) {
+            total_weight += class_weights[i];
         }
-
-        // Normalize
-        double total_weight = class_weights.sum().item<double>();
         if (total_weight == 0) return 0.0;
 
-        class_weights /= total_weight;
-
         // Calculate Gini impurity: 1 - sum(p_i^2)
         double gini = 1.0;
         for (int i = 0; i < n_classes; i++) {
-            double p = class_weights[i].item<double>();
+            double p = class_weights[i] / total_weight;
             gini -= p * p;
         }
-
         return gini;
     }
 
-
-    torch::Tensor DecisionTree::predict(torch::Tensor& X)
+    void DecisionTree::flattenTree()
+    {
+        flat = FlatTree();
+        flattenNode(root.get());
+    }
+    int DecisionTree::flattenNode(const TreeNode* node)
+    {
+        if (!node) {
+            throw std::runtime_error("Null node encountered during tree traversal");
+        }
+        int index = flat.feature.size();
+        flat.feature.push_back(-1);
+        flat.value.push_back(-1);
+        flat.left.push_back(-1);
+        flat.right.push_back(-1);
+        flat.leaf_class.push_back(node->predicted_class);
+        flat.leaf_offset.push_back(-1);
+        if (node->is_leaf) {
+            flat.leaf_offset[index] = flat.leaf_probs.size();
+            auto probs = node->class_probabilities.to(torch::kFloat32).contiguous();
+            flat.leaf_probs.insert(flat.leaf_probs.end(), probs.data_ptr<float>(), probs.data_ptr<float>() + probs.numel());
+            return index;
+        }
+        if (!node->left) {
+            throw std::runtime_error("Missing left child in tree");
+        }
+        if (!node->right) {
+            throw std::runtime_error("Missing right child in tree");
+        }
+        flat.feature[index] = node->split_feature;
+        flat.value[index] = node->split_value;
+        int left = flattenNode(node->left.get());
+        int right = flattenNode(node->right.get());
+        flat.left[index] = left;
+        flat.right[index] = right;
+        return index;
+    }
+    void DecisionTree::predictLeaves(const int* X, int n_samples, int* leaves) const
+    {
+        predictLeaves(X, n_samples, n_samples, leaves);
+    }
+    void DecisionTree::predictLeaves(const int* X, int n_samples, long stride, int* leaves) const
+    {
+        // Samples are advanced in blocks, one level at a time, so the loads of several
+        // independent paths are in flight together
+        const int block_size = 16;
+        const int* feature = flat.feature.data();
+        const int* value = flat.value.data();
+        const int* left = flat.left.data();
+        const int* right = flat.right.data();
+        for (int begin = 0; begin < n_samples; begin += block_size) {
+            int end = std::min(n_samples, begin + block_size);
+            for (int i = begin; i < end; ++i) {
+                leaves[i] = 0;
+            }
+            bool pending = true;
+            while (pending) {
+                pending = false;
+                for (int i = begin; i < end; ++i) {
+                    int node = leaves[i];
+                    int f = feature[node];
+                    if (f < 0) {
+                        continue;
+                    }
+                    leaves[i] = X[f * stride + i] == value[node] ? left[node] : right[node];
+                    pending = true;
+                }
+            }
+        }
+    }
+    bool DecisionTree::asStump(int& feature, int& value, int& class_left, int& class_right) const
     {
         if (!fitted) {
             throw std::runtime_error(CLASSIFIER_NOT_FITTED);
         }
-
+        if (flat.feature[0] < 0) {
+            // A single leaf votes the same class for every sample
+            feature = 0;
+            value = 0;
+            class_left = class_right = flat.leaf_class[0];
+            return true;
+        }
+        int left = flat.left[0];
+        int right = flat.right[0];
+        if (flat.feature[left] >= 0 || flat.feature[right] >= 0) {
+            return false;
+        }
+        feature = flat.feature[0];
+        value = flat.value[0];
+        class_left = flat.leaf_class[left];
+        class_right = flat.leaf_class[right];
+        return true;
+    }
+    torch::Tensor DecisionTree::toFeatureMatrix(const torch::Tensor& X) const
+    {
+        if (!fitted) {
+            throw std::runtime_error(CLASSIFIER_NOT_FITTED);
+        }
+        if (X.size(0) != n) {
+            throw std::runtime_error("Input sample has wrong number of features");
+        }
+        return X.to(torch::kInt32).contiguous();
+    }
+    torch::Tensor DecisionTree::predict(torch::Tensor& X)
+    {
+        auto X_data = toFeatureMatrix(X);
         int n_samples = X.size(1);
-        torch::Tensor predictions = torch::zeros({ n_samples }, torch::kInt32);
-
+        std::vector<int> leaves(n_samples);
+        predictLeaves(X_data.data_ptr<int>(), n_samples, leaves.data());
+        torch::Tensor predictions = torch::empty({ n_samples }, torch::kInt32);
+        auto pred_ptr = predictions.data_ptr<int>();
         for (int i = 0; i < n_samples; i++) {
-            auto sample = X.index({ torch::indexing::Slice(), i }).ravel();
-            predictions[i] = predictSample(sample);
+            pred_ptr[i] = flat.leaf_class[leaves[i]];
         }
-
         return predictions;
     }
 
@@ -341,18 +465,15 @@ namespace bayesnet {
 
     torch::Tensor DecisionTree::predict_proba(torch::Tensor& X)
     {
-        if (!fitted) {
-            throw std::runtime_error(CLASSIFIER_NOT_FITTED);
-        }
-
+        auto X_data = toFeatureMatrix(X);
         int n_samples = X.size(1);
-        torch::Tensor probabilities = torch::zeros({ n_samples, n_classes });
-
+        std::vector<int> leaves(n_samples);
+        predictLeaves(X_data.data_ptr<int>(), n_samples, leaves.data());
+        torch::Tensor probabilities = torch::empty({ n_samples, n_classes }, torch::kFloat32);
+        auto proba_ptr = probabilities.data_ptr<float>();
         for (int i = 0; i < n_samples; i++) {
-            auto sample = X.index({ torch::indexing::Slice(), i }).ravel();
-            probabilities[i] = predictProbaSample(sample);
+            std::copy_n(leafProbabilities(leaves[i]), n_classes, proba_ptr + static_cast<long>(i) * n_classes);
         }
-
         return probabilities;
     }
 
@@ -375,51 +496,17 @@ namespace bayesnet {
 
     int DecisionTree::predictSample(const torch::Tensor& x) const
     {
-        if (!fitted) {
-            throw std::runtime_error(CLASSIFIER_NOT_FITTED);
-        }
-
-        if (x.size(0) != n) {  // n debería ser el número de características
-            throw std::runtime_error("Input sample has wrong number of features");
-        }
-
-        const TreeNode* leaf = traverseTree(x, root.get());
-        return leaf->predicted_class;
+        auto x_data = toFeatureMatrix(x);
+        int leaf;
+        predictLeaves(x_data.data_ptr<int>(), 1, &leaf);
+        return flat.leaf_class[leaf];
     }
     torch::Tensor DecisionTree::predictProbaSample(const torch::Tensor& x) const
     {
-        const TreeNode* leaf = traverseTree(x, root.get());
-        return leaf->class_probabilities.clone();
-    }
-
-
-    const TreeNode* DecisionTree::traverseTree(const torch::Tensor& x, const TreeNode* node) const
-    {
-        if (!node) {
-            throw std::runtime_error("Null node encountered during tree traversal");
-        }
-
-        if (node->is_leaf) {
-            return node;
-        }
-
-        if (node->split_feature < 0 || node->split_feature >= x.size(0)) {
-            throw std::runtime_error("Invalid split_feature index: " + std::to_string(node->split_feature));
-        }
-
-        int feature_value = x[node->split_feature].item<int>();
-
-        if (feature_value == node->split_value) {
-            if (!node->left) {
-                throw std::runtime_error("Missing left child in tree");
-            }
-            return traverseTree(x, node->left.get());
-        } else {
-            if (!node->right) {
-                throw std::runtime_error("Missing right child in tree");
-            }
-            return traverseTree(x, node->right.get());
-        }
+        auto x_data = toFeatureMatrix(x);
+        int leaf;
+        predictLeaves(x_data.data_ptr<int>(), 1, &leaf);
+        return torch::from_blob(const_cast<float*>(leafProbabilities(leaf)), { n_classes }, torch::kFloat32).clone();
     }
 
     std::vector<std::string> DecisionTree::graph(const std::string& title) const
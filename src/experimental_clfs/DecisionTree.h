@@ -48,6 +48,21 @@ namespace bayesnet {
         // Make probabilistic predictions for a single sample
         torch::Tensor predictProbaSample(const torch::Tensor& x) const;
 
+        // Batched traversal over a raw n_features x n_samples int32 matrix (one row per feature),
+        // storing in leaves[i] the node reached by sample i
+        void predictLeaves(const int* X, int n_samples, int* leaves) const;
+        // Same traversal over the first n_samples columns of a matrix whose rows are stride apart
+        void predictLeaves(const int* X, int n_samples, long stride, int* leaves) const;
+        // Depth one trees (one split or a single leaf) as the split and the class of each branch,
+        // returns false for deeper trees
+        bool asStump(int& feature, int& value, int& class_left, int& class_right) const;
+        // Nodes in preorder: split feature (-1 in leaves) and split value of each one
+        int nodeCount() const { return flat.feature.size(); }
+        int splitFeature(int node) const { return flat.feature[node]; }
+        int splitValue(int node) const { return flat.value[node]; }
+        int leafClass(int node) const { return flat.leaf_class[node]; }
+        const float* leafProbabilities(int node) const { return &flat.leaf_probs[flat.leaf_offset[node]]; }
+
     protected:
         void buildModel(const torch::Tensor& weights) override;
         void trainModel(const torch::Tensor& weights, const Smoothing_t smoothing) override
@@ -68,6 +83,22 @@ namespace bayesnet {
         // Root of the decision tree
         std::unique_ptr<TreeNode> root;
 
+        // Same tree as contiguous arrays (structure of arrays) used to predict, nodes in preorder
+        struct FlatTree {
+            std::vector<int> feature;      // split feature, -1 in leaves
+            std::vector<int> value;        // split value, samples with x[feature] == value go left
+            std::vector<int> left;
+            std::vector<int> right;
+            std::vector<int> leaf_class;   // predicted class in leaves
+            std::vector<int> leaf_offset;  // offset of the class probabilities in leaf_probs
+            std::vector<float> leaf_probs;
+        };
+        FlatTree flat;
+        void flattenTree();
+        int flattenNode(const TreeNode* node);
+        // Checks and converts X to a contiguous n_features x n_samples int32 matrix
+        torch::Tensor toFeatureMatrix(const torch::Tensor& X) const;
+
         // Build tree recursively
         std::unique_ptr<TreeNode> buildTree(
             const torch::Tensor& X,
@@ -91,16 +122,10 @@ namespace bayesnet {
             const torch::Tensor& sample_weights
         );
 
-        // Calculate weighted Gini impurity for multi-class
-        double calculateGiniImpurity(
-            const torch::Tensor& y,
-            const torch::Tensor& sample_weights
-        );
-
-
-
-        // Traverse tree to find leaf node
-        const TreeNode* traverseTree(const torch::Tensor& x, const TreeNode* node) const;
+        // Gini impurity from the weights of each class (n_classes values)
+        double giniImpurity(const double* class_weights) const;
+        // Normalized weights of each class in a leaf
+        torch::Tensor classProbabilities(const torch::Tensor& y, const torch::Tensor& sample_weights) const;
 
         // Convert tree to graph representation
         void treeToGraph(
@@ -8,7 +8,7 @@
 #include "common/TensorUtils.hpp"
 
 namespace platform {
-    ExpClf::ExpClf() : semaphore_{ CountingSemaphore::getInstance() }, Boost(false)
+    ExpClf::ExpClf() : pool_{ ThreadPool::getInstance() }, Boost(false)
     {
         validHyperparameters = {};
     }
@@ -36,33 +36,16 @@ namespace platform {
         int test_size = test_data[0].size();
         int sample_size = test_data.size();
         auto predictions = std::vector<int>(test_size);
-
-        int chunk_size = std::min(150, int(test_size / semaphore_.getMaxCount()) + 1);
-        std::vector<std::thread> threads;
-        auto worker = [&](const std::vector<std::vector<int>>& samples, int begin, int chunk, int sample_size, std::vector<int>& predictions) {
-            std::string threadName = "(V)PWorker-" + std::to_string(begin) + "-" + std::to_string(chunk);
-#if defined(__linux__)
-            pthread_setname_np(pthread_self(), threadName.c_str());
-#else
-            pthread_setname_np(threadName.c_str());
-#endif
+        int chunk_size = std::min(150, int(test_size / pool_.getConcurrency()) + 1);
+        pool_.parallel_for(0, test_size, chunk_size, [&](int begin, int end) {
             std::vector<int> instance(sample_size);
-            for (int sample = begin; sample < begin + chunk; ++sample) {
+            for (int sample = begin; sample < end; ++sample) {
                 for (int feature = 0; feature < sample_size; ++feature) {
-                    instance[feature] = samples[feature][sample];
+                    instance[feature] = test_data[feature][sample];
                 }
                 predictions[sample] = aode_.predict_spode(instance, parent);
             }
-            semaphore_.release();
-            };
-        for (int begin = 0; begin < test_size; begin += chunk_size) {
-            int chunk = std::min(chunk_size, test_size - begin);
-            semaphore_.acquire();
-            threads.emplace_back(worker, test_data, begin, chunk, sample_size, std::ref(predictions));
-        }
-        for (auto& thread : threads) {
-            thread.join();
-        }
+            });
         return predictions;
     }
     torch::Tensor ExpClf::predict(torch::Tensor& X)
@@ -94,36 +77,11 @@ namespace platform {
     std::vector<std::vector<double>> ExpClf::predict_proba(const std::vector<std::vector<int>>& test_data)
     {
         int test_size = test_data[0].size();
-        int sample_size = test_data.size();
         auto probabilities = std::vector<std::vector<double>>(test_size, std::vector<double>(aode_.statesClass()));
-
-        int chunk_size = std::min(150, int(test_size / semaphore_.getMaxCount()) + 1);
-        std::vector<std::thread> threads;
-        auto worker = [&](const std::vector<std::vector<int>>& samples, int begin, int chunk, int sample_size, std::vector<std::vector<double>>& predictions) {
-            std::string threadName = "(V)PWorker-" + std::to_string(begin) + "-" + std::to_string(chunk);
-#if defined(__linux__)
-            pthread_setname_np(pthread_self(), threadName.c_str());
-#else
-            pthread_setname_np(threadName.c_str());
-#endif
-
-            std::vector<int> instance(sample_size);
-            for (int sample = begin; sample < begin + chunk; ++sample) {
-                for (int feature = 0; feature < sample_size; ++feature) {
-                    instance[feature] = samples[feature][sample];
-                }
-                predictions[sample] = aode_.predict_proba(instance);
-            }
-            semaphore_.release();
-            };
-        for (int begin = 0; begin < test_size; begin += chunk_size) {
-            int chunk = std::min(chunk_size, test_size - begin);
-            semaphore_.acquire();
-            threads.emplace_back(worker, test_data, begin, chunk, sample_size, std::ref(probabilities));
-        }
-        for (auto& thread : threads) {
-            thread.join();
-        }
+        int chunk_size = std::min(150, int(test_size / pool_.getConcurrency()) + 1);
+        pool_.parallel_for(0, test_size, chunk_size, [&](int begin, int end) {
+            aode_.predict_proba_batch(test_data, begin, end, probabilities);
+            });
         return probabilities;
     }
     std::vector<int> ExpClf::predict(std::vector<std::vector<int>>& test_data)
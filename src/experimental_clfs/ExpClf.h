@@ -14,7 +14,7 @@
 #include <bayesnet/ensembles/Boost.h>
 #include <bayesnet/network/Smoothing.h>
 #include "common/Timer.hpp"
-#include "CountingSemaphore.hpp"
+#include "ThreadPool.hpp"
 #include "Xaode.hpp"
 
 namespace platform {
@@ -61,7 +61,7 @@ namespace platform {
             }
         }
     private:
-        CountingSemaphore& semaphore_;
+        ThreadPool& pool_;
     };
 }
 #endif // EXPCLF_H
\ No newline at end of file
@@ -0,0 +1,204 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CountingSemaphore.hpp"
+
+//
+// Process wide pool of workers, created on first use and reused by every prediction.
+// Each worker owns a queue, guarded by its own lock, and takes its newest task from the back;
+// when it is empty it steals the oldest task from the front of the other queues.
+// parallel_for splits a range in chunks and blocks until all of them are done; the calling
+// thread runs chunks too, so nested calls from inside a worker can't starve the pool.
+// A chunk is queued as a range of the batch, so there is one body per call and not per chunk.
+//
+class ThreadPool {
+public:
+    static ThreadPool& getInstance()
+    {
+        static ThreadPool instance;
+        return instance;
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+    // Number of threads running chunks, the calling thread included
+    uint getConcurrency() const
+    {
+        return static_cast<uint>(workers_.size()) + 1;
+    }
+    // Calls body(begin_chunk, end_chunk) over [begin, end) in chunks of at most grain elements
+    void parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& body)
+    {
+        if (end <= begin) {
+            return;
+        }
+        grain = std::max(1, grain);
+        if (workers_.empty() || end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+        auto batch = std::make_shared<Batch>();
+        batch->body = &body;
+        int n_chunks = (end - begin + grain - 1) / grain;
+        batch->pending = n_chunks;
+        queued_ += n_chunks;
+        // A worker keeps the chunks of its nested calls in its own queue, other threads spread them
+        size_t home = worker_index();
+        size_t n_queues = queues_.size();
+        size_t first = home < n_queues ? home : next_queue_.fetch_add(1) % n_queues;
+        size_t used_queues = home < n_queues ? 1 : std::min<size_t>(n_queues, n_chunks);
+        for (size_t q = 0; q < used_queues; ++q) {
+            auto& queue = *queues_[(first + q) % n_queues];
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            for (int chunk = begin + static_cast<int>(q) * grain; chunk < end; chunk += static_cast<int>(used_queues) * grain) {
+                queue.tasks.push_back({ batch, chunk, std::min(end, chunk + grain) });
+            }
+        }
+        {
+            // Taking the lock orders the notification after the check of a worker going to sleep
+            std::lock_guard<std::mutex> lock(mtx_);
+        }
+        cv_.notify_all();
+        // Help with the pending work until this batch is finished
+        while (batch->pending > 0) {
+            Task task;
+            if (pop(home, task)) {
+                run(task);
+            } else {
+                std::unique_lock<std::mutex> lock(batch->mtx);
+                batch->cv.wait(lock, [&batch]() { return batch->pending == 0; });
+            }
+        }
+        if (batch->error) {
+            std::rethrow_exception(batch->error);
+        }
+    }
+private:
+    struct Batch {
+        const std::function<void(int, int)>* body = nullptr; // owned by the caller, who waits for the batch
+        std::atomic<int> pending{ 0 };
+        std::exception_ptr error;
+        std::mutex mtx;
+        std::condition_variable cv;
+    };
+    struct Task {
+        std::shared_ptr<Batch> batch;
+        int begin = 0;
+        int end = 0;
+    };
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+    ThreadPool()
+    {
+        uint n_workers = CountingSemaphore::getInstance().getMaxCount() - 1;
+        for (uint i = 0; i < std::max(1u, n_workers); ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (uint i = 0; i < n_workers; ++i) {
+            workers_.emplace_back([this, i]() { loop(i); });
+        }
+    }
+    // Index of the queue owned by the calling thread, or npos if it is not a worker of the pool
+    static size_t& worker_index()
+    {
+        thread_local size_t index = std::string::npos;
+        return index;
+    }
+    // Takes the newest task of queue home or steals the oldest one of another queue
+    bool pop(size_t home, Task& task)
+    {
+        if (queued_ == 0) {
+            return false;
+        }
+        size_t n_queues = queues_.size();
+        if (home < n_queues) {
+            auto& queue = *queues_[home];
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                --queued_;
+                return true;
+            }
+        }
+        size_t start = home < n_queues ? home + 1 : next_queue_.load();
+        for (size_t i = 0; i < n_queues; ++i) {
+            auto& queue = *queues_[(start + i) % n_queues];
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                --queued_;
+                return true;
+            }
+        }
+        return false;
+    }
+    void run(Task& task)
+    {
+        try {
+            (*task.batch->body)(task.begin, task.end);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(task.batch->mtx);
+            if (!task.batch->error)
+                task.batch->error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(task.batch->mtx);
+        if (--task.batch->pending == 0) {
+            task.batch->cv.notify_all();
+        }
+    }
+    void loop(size_t home)
+    {
+        worker_index() = home;
+        std::string threadName = "(V)Pool-" + std::to_string(home);
+#if defined(__linux__)
+        pthread_setname_np(pthread_self(), threadName.c_str());
+#else
+        pthread_setname_np(threadName.c_str());
+#endif
+        while (true) {
+            Task task;
+            if (pop(home, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_) {
+                return;
+            }
+        }
+    }
+    std::mutex mtx_; // only for the workers going to sleep and for stopping them
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{ 0 };
+    std::atomic<size_t> queued_{ 0 };
+    bool stop_ = false;
+};
+#endif
@@ -8,13 +8,68 @@
 #include "common/TensorUtils.hpp"
 
 namespace platform {
+    XA1DE::XA1DE() : ExpClf()
+    {
+        validHyperparameters = { "table_mode" };
+    }
+    void XA1DE::setHyperparameters(const nlohmann::json& hyperparameters_)
+    {
+        auto hyperparameters = hyperparameters_;
+        auto it = hyperparameters.find("table_mode");
+        if (it != hyperparameters.end()) {
+            // Storage of the probability tables: probs (default), log64 or log32
+            auto mode = it->get<std::string>();
+            if (mode == "probs") {
+                aode_.setTableMode(Xaode::TableMode::PROBS);
+            } else if (mode == "log64") {
+                aode_.setTableMode(Xaode::TableMode::LOG64);
+            } else if (mode == "log32") {
+                aode_.setTableMode(Xaode::TableMode::LOG32);
+            } else {
+                throw std::invalid_argument("Invalid table_mode: " + mode + ". Valid values: probs, log64, log32");
+            }
+            hyperparameters.erase("table_mode");
+        }
+        // The rest keep the behaviour of the base classifier
+        ExpClf::setHyperparameters(hyperparameters);
+    }
     void XA1DE::trainModel(const torch::Tensor& weights, const bayesnet::Smoothing_t smoothing)
     {
+        int num_instances = dataset.size(1);
+        weights_ = torch::full({ num_instances }, 1.0);
+        if (subtract_total != nullptr) {
+            subtracted = aode_.fitSubtracting(*subtract_total, TensorUtils::to_matrix(subtract_X), TensorUtils::to_vector<int>(subtract_y), smoothing);
+            if (subtracted) {
+                return;
+            }
+        }
         auto X = TensorUtils::to_matrix(dataset.slice(0, 0, dataset.size(0) - 1));
         auto y = TensorUtils::to_vector<int>(dataset.index({ -1, "..." }));
-        int num_instances = X[0].size();
-        weights_ = torch::full({ num_instances }, 1.0);
         //normalize_weights(num_instances);
         aode_.fit(X, y, features, className, states, weights_, true, smoothing);
     }
+    std::shared_ptr<const Xaode> XA1DE::countTotal(const torch::Tensor& X, const torch::Tensor& y)
+    {
+        auto total = std::make_shared<Xaode>();
+        total->fitCounts(TensorUtils::to_matrix(X), TensorUtils::to_vector<int>(y), true);
+        return total;
+    }
+    bool XA1DE::fitSubtracting(const Xaode& total, torch::Tensor& X_train, torch::Tensor& y_train, const torch::Tensor& X_test, const torch::Tensor& y_test, const std::vector<std::string>& features, const std::string& className, std::map<std::string, std::vector<int>>& states, const bayesnet::Smoothing_t smoothing)
+    {
+        // fit does the bookkeeping of the train samples (dataset, states, status...) and trainModel takes the counts
+        subtract_total = &total;
+        subtract_X = X_test;
+        subtract_y = y_test;
+        subtracted = false;
+        try {
+            fit(X_train, y_train, features, className, states, smoothing);
+        }
+        catch (...) {
+            subtract_total = nullptr;
+            throw;
+        }
+        subtract_total = nullptr;
+        subtract_X = subtract_y = torch::Tensor();
+        return subtracted;
+    }
 }
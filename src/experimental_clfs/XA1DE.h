@@ -6,6 +6,7 @@
 
 #ifndef XA1DE_H
 #define XA1DE_H
+#include <memory>
 #include "Xaode.hpp"
 #include "ExpClf.h"
 #include <bayesnet/network/Smoothing.h>
@@ -13,14 +14,28 @@
 namespace platform {
     class XA1DE : public ExpClf {
     public:
-        XA1DE() = default;
+        XA1DE();
         virtual ~XA1DE() override = default;
         std::string getVersion() override { return version; };
+        void setHyperparameters(const nlohmann::json& hyperparameters_) override;
+        //
+        // Cross validation by count subtraction
+        //
+        // Counts of the samples of a whole dataset (X is n_features x n_samples), shared by its folds
+        static std::shared_ptr<const Xaode> countTotal(const torch::Tensor& X, const torch::Tensor& y);
+        // Fits a fold through fit, with the model taken from the dataset counts removing the fold test samples,
+        // the same one the train samples give. If the train samples lose a state of the dataset the counts
+        // can't be used and the model is fitted from them. Returns whether the counts were subtracted
+        bool fitSubtracting(const Xaode& total, torch::Tensor& X_train, torch::Tensor& y_train, const torch::Tensor& X_test, const torch::Tensor& y_test, const std::vector<std::string>& features, const std::string& className, std::map<std::string, std::vector<int>>& states, const bayesnet::Smoothing_t smoothing);
     protected:
         void buildModel(const torch::Tensor& weights) override {};
         void trainModel(const torch::Tensor& weights, const bayesnet::Smoothing_t smoothing) override;
     private:
         std::string version = "1.0.0";
+        // Counts and test samples of the fold being fitted by fitSubtracting
+        const Xaode* subtract_total = nullptr;
+        torch::Tensor subtract_X, subtract_y;
+        bool subtracted = false;
     };
 }
 #endif // XA1DE_H
\ No newline at end of file
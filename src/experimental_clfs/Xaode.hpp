@@ -19,6 +19,10 @@
 #include <sstream>
 #include <torch/torch.h>
 #include <bayesnet/network/Smoothing.h>
+#include "ThreadPool.hpp"
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 
 namespace platform {
@@ -32,6 +36,16 @@ namespace platform {
             COUNTS,
             PROBS
         };
+        // -------------------------------------------------------
+        // Storage of the probability tables once fitted:
+        // PROBS multiplies double probabilities scaled by initializer_,
+        // LOG64/LOG32 keep log-probabilities as double/float and add them,
+        // releasing the double tables (LOG32 halves their memory).
+        enum class TableMode {
+            PROBS,
+            LOG64,
+            LOG32
+        };
         std::vector<double> significance_models_;
         Xaode() : nFeatures_{ 0 }, statesClass_{ 0 }, matrixState_{ MatrixState::EMPTY } {}
         // -------------------------------------------------------
@@ -53,76 +67,59 @@ namespace platform {
         void fit(std::vector<std::vector<int>>& X, std::vector<int>& y, const std::vector<std::string>& features, const std::string& className, std::map<std::string, std::vector<int>>& states, const torch::Tensor& weights, const bool all_parents, const bayesnet::Smoothing_t smoothing)
         {
             int num_instances = X[0].size();
-            nFeatures_ = X.size();
-
-            significance_models_.resize(nFeatures_, (all_parents ? 1.0 : 0.0));
-            for (int i = 0; i < nFeatures_; i++) {
-                if (all_parents) active_parents.push_back(i);
-                states_.push_back(*max_element(X[i].begin(), X[i].end()) + 1);
-            }
-            states_.push_back(*max_element(y.begin(), y.end()) + 1);
-            //
-            statesClass_ = states_.back();
-            classCounts_.resize(statesClass_, 0.0);
-            classPriors_.resize(statesClass_, 0.0);
-            //
-            // Initialize data structures
-            //
-            active_parents.resize(nFeatures_);
-            int totalStates = std::accumulate(states_.begin(), states_.end(), 0) - statesClass_;
-
-            // For p(x_i=si | c), we store them in a 1D array classFeatureProbs_ after we compute.
-            // We'll need the offsets for each feature i in featureClassOffset_.
-            featureClassOffset_.resize(nFeatures_);
-            // We'll store p(x_child=sj | c, x_sp=si) for each pair (i<j).
-            // So data_(i, si, j, sj, c) indexes into a big 1D array with an offset.
-            // For p(x_i=si | c), we store them in a 1D array classFeatureProbs_ after we compute.
-            // We'll need the offsets for each feature i in featureClassOffset_.
-            featureClassOffset_.resize(nFeatures_);
-            pairOffset_.resize(totalStates);
-            int feature_offset = 0;
-            int runningOffset = 0;
-            int feature = 0, index = 0;
-            for (int i = 0; i < nFeatures_; ++i) {
-                featureClassOffset_[i] = feature_offset;
-                feature_offset += states_[i];
-                for (int j = 0; j < states_[i]; ++j) {
-                    pairOffset_[feature++] = index;
-                    index += runningOffset;
-                }
-                runningOffset += states_[i];
-            }
-            int totalSize = index * statesClass_;
-            data_.resize(totalSize);
-            dataOpp_.resize(totalSize);
-
-            classFeatureCounts_.resize(feature_offset * statesClass_);
-            classFeatureProbs_.resize(feature_offset * statesClass_);
-
-            matrixState_ = MatrixState::COUNTS;
+            initialize(X, y, all_parents);
             //
             // Add samples
             //
-            std::vector<int> instance(nFeatures_ + 1);
-            for (int n_instance = 0; n_instance < num_instances; n_instance++) {
-                for (int feature = 0; feature < nFeatures_; feature++) {
-                    instance[feature] = X[feature][n_instance];
-                }
-                instance[nFeatures_] = y[n_instance];
-                addSample(instance, weights[n_instance].item<double>());
+            auto weights_d = weights.to(torch::kDouble).contiguous();
+            addSamples(X, y, weights_d.data_ptr<double>());
+            setSmoothing(smoothing, num_instances);
+            computeProbabilities();
+        }
+        // -------------------------------------------------------
+        // fitCounts / fitSubtracting
+        // -------------------------------------------------------
+        //
+        // Cross validation by count subtraction: fitCounts keeps the raw counts of a whole
+        // dataset (unit weights) in COUNTS mode, and fitSubtracting builds the model of a fold
+        // from them removing the counts of the fold test samples. The counts are integers, so
+        // the model is the same as fitting the train samples with unit weights. The fold is
+        // refused (returns false and leaves the model EMPTY) when its train samples don't have
+        // the states of the whole dataset, as fit would build tables of another shape.
+        //
+        void fitCounts(const std::vector<std::vector<int>>& X, const std::vector<int>& y, const bool all_parents)
+        {
+            initialize(X, y, all_parents);
+            std::vector<double> weights(y.size(), 1.0);
+            addSamples(X, y, weights.data());
+        }
+        // Sizes the tables for the states of X and y with no sample counted (COUNTS mode), the samples are then
+        // added with addSample or addSamples
+        void initializeCounts(const std::vector<std::vector<int>>& X, const std::vector<int>& y, const bool all_parents)
+        {
+            initialize(X, y, all_parents);
+        }
+        // Pair updates (instances x features^2 / 2) from which addSamples splits the counting among the pool workers
+        void setParallelCountThreshold(double pair_updates) { parallelCountThreshold_ = pair_updates; }
+        bool fitSubtracting(const Xaode& total, const std::vector<std::vector<int>>& X_test, const std::vector<int>& y_test, const bayesnet::Smoothing_t smoothing)
+        {
+            if (total.matrixState_ != MatrixState::COUNTS) {
+                throw std::logic_error("fitSubtracting: the total counts must be in COUNTS mode.");
             }
-            switch (smoothing) {
-                case bayesnet::Smoothing_t::ORIGINAL:
-                    alpha_ = 1.0 / num_instances;
-                    break;
-                case bayesnet::Smoothing_t::LAPLACE:
-                    alpha_ = 1.0;
-                    break;
-                default:
-                    alpha_ = 0.0; // No smoothing 
+            auto mode = tableMode_;
+            *this = total;
+            tableMode_ = mode;
+            std::vector<double> weights(y_test.size(), 1.0);
+            updateCounts(X_test, y_test, weights.data(), -1.0);
+            if (!countsKeepStates()) {
+                *this = Xaode();
+                tableMode_ = mode;
+                return false;
             }
-            initializer_ = std::numeric_limits<double>::max() / (nFeatures_ * nFeatures_);
+            double num_instances = std::accumulate(classCounts_.begin(), classCounts_.end(), 0.0);
+            setSmoothing(smoothing, static_cast<int>(std::lround(num_instances)));
             computeProbabilities();
+            return true;
         }
         std::string to_string() const
         {
@@ -191,6 +188,22 @@ namespace platform {
             }
         }
         // -------------------------------------------------------
+        // addSamples (only in COUNTS mode)
+        // -------------------------------------------------------
+        //
+        // Same counts as calling addSample for every instance of X (one vector per
+        // feature). The parents are split in groups of similar cost (parent p updates
+        // p pair rows) and each group is counted by a worker, so every table cell is
+        // owned by one worker and is accumulated in the instances order: the result
+        // doesn't depend on the number of workers. Instances are traversed in blocks
+        // so the columns of a block stay in cache while all the parents of the group
+        // are counted.
+        //
+        void addSamples(const std::vector<std::vector<int>>& X, const std::vector<int>& y, const double* weights)
+        {
+            updateCounts(X, y, weights, 1.0);
+        }
+        // -------------------------------------------------------
         // computeProbabilities
         // -------------------------------------------------------
         //
@@ -268,6 +281,22 @@ namespace platform {
                 }
             }
             matrixState_ = MatrixState::PROBS;
+            if (tableMode_ == TableMode::LOG64) {
+                buildLogTables(log64_);
+            } else if (tableMode_ == TableMode::LOG32) {
+                buildLogTables(log32_);
+            }
+        }
+        void setTableMode(TableMode mode)
+        {
+            if (matrixState_ == MatrixState::PROBS) {
+                throw std::logic_error("setTableMode: must be set before fitting the model.");
+            }
+            tableMode_ = mode;
+        }
+        TableMode tableMode() const
+        {
+            return tableMode_;
         }
         // -------------------------------------------------------
         // predict_proba_spode
@@ -286,7 +315,14 @@ namespace platform {
             // accumulates posterior probabilities for each class
             auto probs = std::vector<double>(statesClass_);
             auto spodeProbs = std::vector<double>(statesClass_, 0.0);
-            if (std::find(active_parents.begin(), active_parents.end(), parent) == active_parents.end()) {
+            if (parent < 0 || parent >= nFeatures_ || !activeMask_[parent]) {
+                return spodeProbs;
+            }
+            if (tableMode_ == TableMode::LOG64) {
+                predict_log_spode(log64_, instance, parent, spodeProbs);
+                return spodeProbs;
+            } else if (tableMode_ == TableMode::LOG32) {
+                predict_log_spode(log32_, instance, parent, spodeProbs);
                 return spodeProbs;
             }
             // Initialize the probabilities with the feature|class probabilities x class priors
@@ -343,12 +379,21 @@ namespace platform {
         {
             // accumulates posterior probabilities for each class
             auto probs = std::vector<double>(statesClass_);
+            if (tableMode_ == TableMode::LOG64) {
+                std::vector<double> rows(nFeatures_ * statesClass_);
+                predict_log(log64_, activeMask_, instance, rows, probs);
+                return probs;
+            } else if (tableMode_ == TableMode::LOG32) {
+                std::vector<float> rows(nFeatures_ * statesClass_);
+                predict_log(log32_, activeMask_, instance, rows, probs);
+                return probs;
+            }
             auto spodeProbs = std::vector<std::vector<double>>(nFeatures_, std::vector<double>(statesClass_));
             // Initialize the probabilities with the feature|class probabilities
             int localOffset;
             for (int feature = 0; feature < nFeatures_; ++feature) {
                 // if feature is not in the active_parents, skip it
-                if (std::find(active_parents.begin(), active_parents.end(), feature) == active_parents.end()) {
+                if (!activeMask_[feature]) {
                     continue;
                 }
                 localOffset = (featureClassOffset_[feature] + instance[feature]) * statesClass_;
@@ -359,7 +404,7 @@ namespace platform {
             int idx, base, sp, sc, parent_offset;
             for (int parent = 1; parent < nFeatures_; ++parent) {
                 // if parent is not in the active_parents, skip it
-                if (std::find(active_parents.begin(), active_parents.end(), parent) == active_parents.end()) {
+                if (!activeMask_[parent]) {
                     continue;
                 }
                 sp = instance[parent];
@@ -396,6 +441,75 @@ namespace platform {
             normalize(probs);
             return probs;
         }
+        // -------------------------------------------------------
+        // predict_proba_batch
+        // -------------------------------------------------------
+        //
+        // Same computation as predict_proba for the instances [begin, end) of X
+        // (one vector per feature), writing statesClass_ values in probs[instance].
+        // The active parents are resolved once in a mask, the scratch rows are
+        // allocated once per batch and the class loops use SIMD when available,
+        // with the multiplications in the same order, so the results are identical
+        // (ENABLE_NATIVE_ARCH builds with -ffp-contract=off, so neither path is fused into FMA).
+        //
+        void predict_proba_batch(const std::vector<std::vector<int>>& X, int begin, int end, std::vector<std::vector<double>>& probs) const
+        {
+            const auto& active = activeMask_;
+            if (tableMode_ != TableMode::PROBS) {
+                std::vector<int> instance(nFeatures_);
+                std::vector<double> rows64(tableMode_ == TableMode::LOG64 ? nFeatures_ * statesClass_ : 0);
+                std::vector<float> rows32(tableMode_ == TableMode::LOG32 ? nFeatures_ * statesClass_ : 0);
+                for (int sample = begin; sample < end; ++sample) {
+                    for (int feature = 0; feature < nFeatures_; ++feature) {
+                        instance[feature] = X[feature][sample];
+                    }
+                    if (tableMode_ == TableMode::LOG64) {
+                        predict_log(log64_, active, instance, rows64, probs[sample]);
+                    } else {
+                        predict_log(log32_, active, instance, rows32, probs[sample]);
+                    }
+                }
+                return;
+            }
+            std::vector<double> spodeProbs(nFeatures_ * statesClass_);
+            std::vector<int> instance(nFeatures_);
+            int localOffset, base;
+            for (int sample = begin; sample < end; ++sample) {
+                for (int feature = 0; feature < nFeatures_; ++feature) {
+                    instance[feature] = X[feature][sample];
+                }
+                std::fill(spodeProbs.begin(), spodeProbs.end(), 0.0);
+                // Initialize the probabilities with the feature|class probabilities
+                for (int feature = 0; feature < nFeatures_; ++feature) {
+                    if (!active[feature]) {
+                        continue;
+                    }
+                    localOffset = (featureClassOffset_[feature] + instance[feature]) * statesClass_;
+                    double* row = &spodeProbs[feature * statesClass_];
+                    for (int c = 0; c < statesClass_; ++c) {
+                        row[c] = classFeatureProbs_[localOffset + c] * classPriors_[c] * initializer_;
+                    }
+                }
+                for (int parent = 1; parent < nFeatures_; ++parent) {
+                    if (!active[parent]) {
+                        continue;
+                    }
+                    int parent_offset = pairOffset_[featureClassOffset_[parent] + instance[parent]];
+                    double* parent_row = &spodeProbs[parent * statesClass_];
+                    for (int child = 0; child < parent; ++child) {
+                        base = (parent_offset + featureClassOffset_[child] + instance[child]) * statesClass_;
+                        multiply(&spodeProbs[child * statesClass_], &dataOpp_[base], statesClass_);
+                        multiply(parent_row, &data_[base], statesClass_);
+                    }
+                }
+                auto& result = probs[sample];
+                result.assign(statesClass_, 0.0);
+                for (int i = 0; i < nFeatures_; ++i) {
+                    add_scaled(result.data(), &spodeProbs[i * statesClass_], significance_models_[i], statesClass_);
+                }
+                normalize(result);
+            }
+        }
         void normalize(std::vector<double>& probs) const
         {
             double sum = std::accumulate(probs.begin(), probs.end(), 0.0);
@@ -437,13 +551,310 @@ namespace platform {
         void add_active_parent(int active_parent)
         {
             active_parents.push_back(active_parent);
+            updateActiveMask();
         }
         void remove_last_parent()
         {
             active_parents.pop_back();
+            updateActiveMask();
         }
 
     private:
+        // Sizes the tables for the states found in the samples and leaves them in COUNTS mode
+        void initialize(const std::vector<std::vector<int>>& X, const std::vector<int>& y, const bool all_parents)
+        {
+            nFeatures_ = X.size();
+            significance_models_.resize(nFeatures_, (all_parents ? 1.0 : 0.0));
+            for (int i = 0; i < nFeatures_; i++) {
+                if (all_parents) active_parents.push_back(i);
+                states_.push_back(*max_element(X[i].begin(), X[i].end()) + 1);
+            }
+            states_.push_back(*max_element(y.begin(), y.end()) + 1);
+            //
+            statesClass_ = states_.back();
+            classCounts_.resize(statesClass_, 0.0);
+            classPriors_.resize(statesClass_, 0.0);
+            //
+            // Initialize data structures
+            //
+            active_parents.resize(nFeatures_);
+            updateActiveMask();
+            int totalStates = std::accumulate(states_.begin(), states_.end(), 0) - statesClass_;
+
+            // For p(x_i=si | c), we store them in a 1D array classFeatureProbs_ after we compute.
+            // We'll need the offsets for each feature i in featureClassOffset_.
+            featureClassOffset_.resize(nFeatures_);
+            // We'll store p(x_child=sj | c, x_sp=si) for each pair (i<j).
+            // So data_(i, si, j, sj, c) indexes into a big 1D array with an offset.
+            // For p(x_i=si | c), we store them in a 1D array classFeatureProbs_ after we compute.
+            // We'll need the offsets for each feature i in featureClassOffset_.
+            featureClassOffset_.resize(nFeatures_);
+            pairOffset_.resize(totalStates);
+            int feature_offset = 0;
+            int runningOffset = 0;
+            int feature = 0, index = 0;
+            for (int i = 0; i < nFeatures_; ++i) {
+                featureClassOffset_[i] = feature_offset;
+                feature_offset += states_[i];
+                for (int j = 0; j < states_[i]; ++j) {
+                    pairOffset_[feature++] = index;
+                    index += runningOffset;
+                }
+                runningOffset += states_[i];
+            }
+            int totalSize = index * statesClass_;
+            data_.resize(totalSize);
+            dataOpp_.resize(totalSize);
+
+            classFeatureCounts_.resize(feature_offset * statesClass_);
+            classFeatureProbs_.resize(feature_offset * statesClass_);
+
+            matrixState_ = MatrixState::COUNTS;
+            initializer_ = std::numeric_limits<double>::max() / (nFeatures_ * nFeatures_);
+        }
+        void setSmoothing(const bayesnet::Smoothing_t smoothing, int num_instances)
+        {
+            switch (smoothing) {
+                case bayesnet::Smoothing_t::ORIGINAL:
+                    alpha_ = 1.0 / num_instances;
+                    break;
+                case bayesnet::Smoothing_t::LAPLACE:
+                    alpha_ = 1.0;
+                    break;
+                default:
+                    alpha_ = 0.0; // No smoothing 
+            }
+        }
+        // Adds (sign 1) or removes (sign -1) the weighted counts of the samples, see addSamples
+        void updateCounts(const std::vector<std::vector<int>>& X, const std::vector<int>& y, const double* weights, const double sign)
+        {
+            const int num_instances = y.size();
+            const int block_size = 4096;
+            for (int n = 0; n < num_instances; ++n) {
+                if (weights[n] > 0.0) {
+                    classCounts_[y[n]] += sign * weights[n];
+                }
+            }
+            // Only worth splitting when there are enough pair updates
+            const double pair_updates = static_cast<double>(num_instances) * nFeatures_ * nFeatures_ / 2;
+            auto& pool = ThreadPool::getInstance();
+            int n_groups = pair_updates < parallelCountThreshold_ ? 1 : std::min<int>(pool.getConcurrency(), nFeatures_);
+            // Greedy balance: heaviest parents first, each one to the least loaded group
+            std::vector<std::vector<int>> groups(n_groups);
+            std::vector<long> load(n_groups, 0);
+            for (int parent = nFeatures_ - 1; parent >= 0; --parent) {
+                auto target = std::distance(load.begin(), std::min_element(load.begin(), load.end()));
+                groups[target].push_back(parent);
+                load[target] += parent + 1;
+            }
+            pool.parallel_for(0, n_groups, 1, [&](int begin, int end) {
+                for (int group = begin; group < end; ++group) {
+                    for (int block = 0; block < num_instances; block += block_size) {
+                        int block_end = std::min(num_instances, block + block_size);
+                        for (int parent : groups[group]) {
+                            const auto& parent_values = X[parent];
+                            const int parent_base = featureClassOffset_[parent];
+                            for (int n = block; n < block_end; ++n) {
+                                double weight = weights[n];
+                                if (weight <= 0.0) {
+                                    continue;
+                                }
+                                int c = y[n];
+                                int sp = parent_values[n];
+                                classFeatureCounts_[(parent_base + sp) * statesClass_ + c] += sign * weight;
+                                int i_offset = pairOffset_[parent_base + sp];
+                                for (int child = 0; child < parent; ++child) {
+                                    data_[(i_offset + featureClassOffset_[child] + X[child][n]) * statesClass_ + c] += sign * weight;
+                                }
+                            }
+                        }
+                    }
+                }
+                });
+        }
+        // true if the states fit would find in the counted samples are the ones of the tables:
+        // the last state of every feature and the last class are present
+        bool countsKeepStates() const
+        {
+            if (classCounts_[statesClass_ - 1] <= 0.0) {
+                return false;
+            }
+            for (int feature = 0; feature < nFeatures_; ++feature) {
+                int base = (featureClassOffset_[feature] + states_[feature] - 1) * statesClass_;
+                if (std::all_of(classFeatureCounts_.begin() + base, classFeatureCounts_.begin() + base + statesClass_, [](double count) { return count <= 0.0; })) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // Log-probability tables, same layout as data_, dataOpp_, classFeatureProbs_ and classPriors_
+        template<typename T>
+        struct LogTables {
+            std::vector<T> data;
+            std::vector<T> dataOpp;
+            std::vector<T> classFeatureProbs;
+            std::vector<T> classPriors;
+        };
+        template<typename T>
+        void buildLogTables(LogTables<T>& tables)
+        {
+            auto to_log = [](const std::vector<double>& source, std::vector<T>& target) {
+                target.resize(source.size());
+                std::transform(source.begin(), source.end(), target.begin(), [](double value) { return static_cast<T>(std::log(value)); });
+                };
+            to_log(data_, tables.data);
+            to_log(dataOpp_, tables.dataOpp);
+            to_log(classFeatureProbs_, tables.classFeatureProbs);
+            to_log(classPriors_, tables.classPriors);
+            // The double tables are not used anymore
+            std::vector<double>().swap(data_);
+            std::vector<double>().swap(dataOpp_);
+            std::vector<double>().swap(classFeatureProbs_);
+        }
+        // Log-space version of predict_proba: each spode adds logs instead of multiplying
+        // probabilities, and the spodes are combined after shifting by the largest log value,
+        // which cancels in the normalization.
+        template<typename T>
+        void predict_log(const LogTables<T>& tables, const std::vector<char>& active, const std::vector<int>& instance, std::vector<T>& rows, std::vector<double>& probs) const
+        {
+            int localOffset, base;
+            for (int feature = 0; feature < nFeatures_; ++feature) {
+                if (!active[feature]) {
+                    continue;
+                }
+                localOffset = (featureClassOffset_[feature] + instance[feature]) * statesClass_;
+                T* row = &rows[feature * statesClass_];
+                for (int c = 0; c < statesClass_; ++c) {
+                    row[c] = tables.classFeatureProbs[localOffset + c] + tables.classPriors[c];
+                }
+            }
+            for (int parent = 1; parent < nFeatures_; ++parent) {
+                if (!active[parent]) {
+                    continue;
+                }
+                int parent_offset = pairOffset_[featureClassOffset_[parent] + instance[parent]];
+                T* parent_row = &rows[parent * statesClass_];
+                for (int child = 0; child < parent; ++child) {
+                    base = (parent_offset + featureClassOffset_[child] + instance[child]) * statesClass_;
+                    if (active[child]) {
+                        T* child_row = &rows[child * statesClass_];
+                        for (int c = 0; c < statesClass_; ++c) {
+                            child_row[c] += tables.dataOpp[base + c];
+                        }
+                    }
+                    for (int c = 0; c < statesClass_; ++c) {
+                        parent_row[c] += tables.data[base + c];
+                    }
+                }
+            }
+            probs.assign(statesClass_, 0.0);
+            double max_log = -std::numeric_limits<double>::infinity();
+            for (int feature = 0; feature < nFeatures_; ++feature) {
+                if (!active[feature] || significance_models_[feature] == 0.0) {
+                    continue;
+                }
+                const T* row = &rows[feature * statesClass_];
+                for (int c = 0; c < statesClass_; ++c) {
+                    max_log = std::max(max_log, static_cast<double>(row[c]));
+                }
+            }
+            if (max_log == -std::numeric_limits<double>::infinity()) {
+                return;
+            }
+            for (int feature = 0; feature < nFeatures_; ++feature) {
+                if (!active[feature] || significance_models_[feature] == 0.0) {
+                    continue;
+                }
+                const T* row = &rows[feature * statesClass_];
+                for (int c = 0; c < statesClass_; ++c) {
+                    probs[c] += std::exp(static_cast<double>(row[c]) - max_log) * significance_models_[feature];
+                }
+            }
+            normalize(probs);
+        }
+        template<typename T>
+        void predict_log_spode(const LogTables<T>& tables, const std::vector<int>& instance, int parent, std::vector<double>& probs) const
+        {
+            int sp = instance[parent];
+            int localOffset = (featureClassOffset_[parent] + sp) * statesClass_;
+            std::vector<T> logProbs(statesClass_);
+            for (int c = 0; c < statesClass_; ++c) {
+                logProbs[c] = tables.classFeatureProbs[localOffset + c] + tables.classPriors[c];
+            }
+            int base, sc;
+            for (int child = 0; child < nFeatures_; ++child) {
+                if (child == parent) {
+                    continue;
+                }
+                sc = instance[child];
+                if (child > parent) {
+                    base = (pairOffset_[featureClassOffset_[child] + sc] + featureClassOffset_[parent] + sp) * statesClass_;
+                } else {
+                    base = (pairOffset_[featureClassOffset_[parent] + sp] + featureClassOffset_[child] + sc) * statesClass_;
+                }
+                const auto& table = child > parent ? tables.dataOpp : tables.data;
+                for (int c = 0; c < statesClass_; ++c) {
+                    logProbs[c] += table[base + c];
+                }
+            }
+            double max_log = static_cast<double>(*std::max_element(logProbs.begin(), logProbs.end()));
+            if (max_log == -std::numeric_limits<double>::infinity()) {
+                return;
+            }
+            for (int c = 0; c < statesClass_; ++c) {
+                probs[c] = std::exp(static_cast<double>(logProbs[c]) - max_log);
+            }
+            normalize(probs);
+        }
+        // activeMask_[feature] is true if feature is in active_parents, rebuilt whenever they change
+        void updateActiveMask()
+        {
+            activeMask_.assign(nFeatures_, 0);
+            for (int parent : active_parents) {
+                if (parent >= 0 && parent < nFeatures_)
+                    activeMask_[parent] = 1;
+            }
+        }
+        // dst[i] *= src[i]
+        static inline void multiply(double* dst, const double* src, int n)
+        {
+            int i = 0;
+#if defined(__AVX512F__)
+            for (; i + 8 <= n; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+            }
+#endif
+#if defined(__AVX2__)
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+            }
+#endif
+            for (; i < n; ++i) {
+                dst[i] *= src[i];
+            }
+        }
+        // dst[i] += src[i] * scale, without fused multiply-add to keep the scalar rounding
+        static inline void add_scaled(double* dst, const double* src, double scale, int n)
+        {
+            int i = 0;
+#if defined(__AVX512F__)
+            auto scale8 = _mm512_set1_pd(scale);
+            for (; i + 8 <= n; i += 8) {
+                auto product = _mm512_mul_pd(_mm512_loadu_pd(src + i), scale8);
+                _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), product));
+            }
+#endif
+#if defined(__AVX2__)
+            auto scale4 = _mm256_set1_pd(scale);
+            for (; i + 4 <= n; i += 4) {
+                auto product = _mm256_mul_pd(_mm256_loadu_pd(src + i), scale4);
+                _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), product));
+            }
+#endif
+            for (; i < n; ++i) {
+                dst[i] += src[i] * scale;
+            }
+        }
         // -----------
         // MEMBER DATA
         // -----------
@@ -472,7 +883,12 @@ namespace platform {
 
         double alpha_ = 1.0; // Laplace smoothing
         double initializer_ = 1.0;
+        TableMode tableMode_ = TableMode::PROBS;
+        double parallelCountThreshold_ = 1e6;
+        LogTables<double> log64_;
+        LogTables<float> log32_;
         std::vector<int> active_parents;
+        std::vector<char> activeMask_;
     };
 }
 #endif // XAODE_H
\ No newline at end of file
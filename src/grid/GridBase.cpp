@@ -1,6 +1,9 @@
 #include <random>
+#include <numeric>
 #include <cstddef>
 #include <cstdio>
+#include <deque>
+#include <map>
 #include "common/DotEnv.h"
 #include "common/Paths.h"
 #include "common/Colors.h"
@@ -36,11 +39,29 @@ namespace platform {
         auto idx = rank % id.size();
         return *(colors.begin() + rank % colors.size()) + id[idx];
     }
-    void GridBase::shuffle_and_progress_bar(json& tasks)
+    double GridBase::task_cost(const json& task, Datasets& datasets)
     {
-        // Shuffle the array so heavy datasets are eas  ier spread across the workers
-        std::mt19937 g{ 271 }; // Use fixed seed to obtain the same shuffle
-        std::shuffle(tasks.begin(), tasks.end(), g);
+        auto stats = datasets.getStats(task["dataset"].get<std::string>());
+        return static_cast<double>(stats.samples) * stats.features;
+    }
+    void GridBase::order_and_progress_bar(json& tasks, Datasets& datasets)
+    {
+        // Longest expected tasks first, so the heavy ones don't start at the end of the run while the rest
+        // of the workers are idle. The shuffle (fixed seed) spreads the tasks with the same cost
+        std::vector<int> order(tasks.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 g{ 271 };
+        std::shuffle(order.begin(), order.end(), g);
+        std::vector<double> costs;
+        for (const auto& task : tasks) {
+            costs.push_back(task_cost(task, datasets));
+        }
+        std::stable_sort(order.begin(), order.end(), [&costs](int a, int b) { return costs[a] > costs[b]; });
+        auto ordered = json::array();
+        for (const auto& i : order) {
+            ordered.push_back(tasks[i]);
+        }
+        tasks = ordered;
         std::cout << "* Number of tasks: " << tasks.size() << std::endl;
         std::cout << separator << std::flush;
         for (int i = 0; i < tasks.size(); ++i) {
@@ -63,8 +84,11 @@ namespace platform {
         *   "fold": # of fold to process
         * }
         * This way a task consists in process all combinations of hyperparameters for a dataset, seed and fold
+        * With a finer granularity the task is split by split_task in evaluation tasks and a refit task
+        * sharing the same "group"
         */
         auto tasks = json::array();
+        int group = 0;
         auto all_datasets = datasets.getNames();
         auto datasets_names = filterDatasets(datasets);
         for (int idx_dataset = 0; idx_dataset < datasets_names.size(); ++idx_dataset) {
@@ -77,13 +101,23 @@ namespace platform {
                         { "seed", seed },
                         { "fold", n_fold},
                     };
-                    tasks.push_back(task);
+                    if (config.granularity == "fold") {
+                        tasks.push_back(task);
+                        continue;
+                    }
+                    for (const auto& subtask : split_task(task, group++)) {
+                        tasks.push_back(subtask);
+                    }
                 }
             }
         }
-        shuffle_and_progress_bar(tasks);
+        order_and_progress_bar(tasks, datasets);
         return tasks;
     }
+    json GridBase::split_task(const json& task, int group)
+    {
+        return json::array({ task });
+    }
     void GridBase::summary(json& all_results, json& tasks, struct ConfigMPI& config_mpi)
     {
         // Report the tasks done by each worker, showing dataset number, seed, fold and time spent
@@ -206,7 +240,7 @@ namespace platform {
         char* msg;
         json tasks;
         auto env = platform::DotEnv();
-        auto datasets = Datasets(config.discretize, Paths::datasets(), env.get("discretize_algo"));
+        auto& datasets = Datasets::shared(config.discretize, Paths::datasets(), env.get("discretize_algo"));
         if (config_mpi.rank == config_mpi.manager) {
             timer.start();
             tasks = build_tasks(datasets);
@@ -257,40 +291,154 @@ namespace platform {
     }
     json GridBase::producer(std::vector<std::string>& names, json& tasks, struct ConfigMPI& config_mpi, MPI_Datatype& MPI_Result)
     {
+        //
+        // Tasks of a group (granularity finer than fold) are the evaluations of the combinations of an outer fold
+        // and its refit task, which is only ready once all the evaluations are done and the best combination is known
+        //
+        struct Group {
+            int pending = 0;
+            int refit = -1;
+            int best = -1;
+            double time = 0.0;
+            std::map<int, std::map<int, double>> scores; // combination -> nested fold -> score
+        };
         Task_Result result;
         json results;
         int num_tasks = tasks.size();
         //
-        // 2a.1 Producer will loop to send all the tasks to the consumers and receive the results
+        // A worker keeps the context of the outer fold of its last group (fold tensors, nested folds and counts),
+        // so it is given the ready tasks of that group before any other one. The tasks are kept in the global
+        // order and in the queue of their group, a task sent from one of them is skipped in the other
         //
+        std::deque<int> ready;
+        std::map<int, std::deque<int>> ready_group;
+        std::vector<bool> sent(num_tasks, false);
+        size_t n_ready = 0;
+        std::map<int, int> worker_group;
+        std::vector<int> idle;
+        std::map<int, Group> groups;
+        auto push_ready = [&](int n_task, bool front) {
+            if (front)
+                ready.push_front(n_task);
+            else
+                ready.push_back(n_task);
+            if (tasks[n_task].contains("group")) {
+                auto& queue = ready_group[tasks[n_task]["group"].get<int>()];
+                if (front)
+                    queue.push_front(n_task);
+                else
+                    queue.push_back(n_task);
+            }
+            n_ready++;
+            };
+        auto pop_ready = [&](std::deque<int>& queue) {
+            while (!queue.empty() && sent[queue.front()]) {
+                queue.pop_front();
+            }
+            if (queue.empty())
+                return -1;
+            int n_task = queue.front();
+            queue.pop_front();
+            return n_task;
+            };
         for (int i = 0; i < num_tasks; ++i) {
+            if (!tasks[i].contains("group")) {
+                push_ready(i, false);
+                continue;
+            }
+            auto& group = groups[tasks[i]["group"].get<int>()];
+            if (tasks[i].contains("refit")) {
+                group.refit = i;
+            } else {
+                group.pending++;
+                push_ready(i, false);
+            }
+        }
+        for (const auto& [_, group] : groups) {
+            if (group.pending == 0)
+                push_ready(group.refit, false);
+        }
+        auto dispatch = [&]() {
+            while (n_ready > 0 && !idle.empty()) {
+                int worker = idle.back();
+                int n_task = -1;
+                auto last = worker_group.find(worker);
+                if (last != worker_group.end()) {
+                    auto queue = ready_group.find(last->second);
+                    if (queue != ready_group.end()) {
+                        n_task = pop_ready(queue->second);
+                        if (queue->second.empty())
+                            ready_group.erase(queue);
+                    }
+                }
+                if (n_task < 0)
+                    n_task = pop_ready(ready);
+                sent[n_task] = true;
+                n_ready--;
+                int message[2] = { n_task, -1 };
+                if (tasks[n_task].contains("group"))
+                    worker_group[worker] = tasks[n_task]["group"].get<int>();
+                if (tasks[n_task].contains("refit"))
+                    message[1] = groups[tasks[n_task]["group"].get<int>()].best;
+                MPI_Send(message, 2, MPI_INT, worker, TAG_TASK, MPI_COMM_WORLD);
+                idle.pop_back();
+            }
+            };
+        //
+        // 2a.1 Producer will loop to send all the tasks to the consumers and receive the results
+        //
+        int received = 0;
+        while (received < num_tasks) {
             MPI_Status status;
             MPI_Recv(&result, 1, MPI_Result, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            idle.push_back(status.MPI_SOURCE);
             if (status.MPI_TAG == TAG_RESULT) {
-                //Store result
-                store_result(names, result, results);
+                received++;
+                auto& task = tasks[result.task];
+                if (task.contains("group") && !task.contains("refit")) {
+                    auto& group = groups[task["group"].get<int>()];
+                    group.scores[task["combination"].get<int>()][task.value("nested", 0)] = result.score;
+                    group.time += result.time;
+                    if (--group.pending == 0) {
+                        // Same selection as a whole fold task: mean of the nested folds, first best combination wins
+                        float best_score = 0.0;
+                        for (const auto& [combination, nested_scores] : group.scores) {
+                            double score = 0.0;
+                            for (const auto& [_, nested_score] : nested_scores) {
+                                score += nested_score;
+                            }
+                            score /= nested_scores.size();
+                            if (score > best_score) {
+                                best_score = score;
+                                group.best = combination;
+                            }
+                        }
+                        push_ready(group.refit, true);
+                    }
+                } else {
+                    if (task.contains("group"))
+                        result.time += groups[task["group"].get<int>()].time;
+                    //Store result
+                    store_result(names, result, results);
+                }
                 // Display progress in the manager process using the worker's rank
                 std::cout << get_color_rank(result.process) << std::flush;
                 std::cout.flush();
                 std::fflush(stdout);
             }
-            MPI_Send(&i, 1, MPI_INT, status.MPI_SOURCE, TAG_TASK, MPI_COMM_WORLD);
+            dispatch();
         }
         //
         // 2a.2 Producer will send the end message to all the consumers
         //
-        for (int i = 0; i < config_mpi.n_procs - 1; ++i) {
+        while (idle.size() < static_cast<size_t>(config_mpi.n_procs - 1)) {
             MPI_Status status;
             MPI_Recv(&result, 1, MPI_Result, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-            if (status.MPI_TAG == TAG_RESULT) {
-                //Store result
-                store_result(names, result, results);
-                // Display progress in the manager process using the worker's rank
-                std::cout << get_color_rank(result.process) << std::flush;
-                std::cout.flush();
-                std::fflush(stdout);
-            }
-            MPI_Send(&i, 1, MPI_INT, status.MPI_SOURCE, TAG_END, MPI_COMM_WORLD);
+            idle.push_back(status.MPI_SOURCE);
+        }
+        for (const auto& worker : idle) {
+            int message[2] = { -1, -1 };
+            MPI_Send(message, 2, MPI_INT, worker, TAG_END, MPI_COMM_WORLD);
         }
         return results;
     }
@@ -301,16 +449,19 @@ namespace platform {
         // 2b.1 Consumers announce to the producer that they are ready to receive a task
         //
         MPI_Send(&result, 1, MPI_Result, config_mpi.manager, TAG_QUERY, MPI_COMM_WORLD);
-        int task;
+        int message[2]; // task, best combination (only used by refit tasks)
         while (true) {
             MPI_Status status;
             //
             // 2b.2 Consumers receive the task from the producer and process it
             //
-            MPI_Recv(&task, 1, MPI_INT, config_mpi.manager, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            MPI_Recv(message, 2, MPI_INT, config_mpi.manager, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
             if (status.MPI_TAG == TAG_END) {
                 break;
             }
+            int task = message[0];
+            if (tasks[task].contains("refit"))
+                tasks[task]["combination"] = message[1];
             consumer_go(config, config_mpi, tasks, task, datasets, &result);
             //
             // 2b.3 Consumers send the result to the producer
@@ -19,13 +19,17 @@ namespace platform {
         void validate_config();
     protected:
         json build_tasks(Datasets& datasets);
+        // Splits a (dataset, seed, fold) task of group into the tasks of the selected granularity
+        virtual json split_task(const json& task, int group);
         virtual void save(json& results) = 0;
         virtual std::vector<std::string> filterDatasets(Datasets& datasets) const = 0;
         virtual json initializeResults() = 0;
         virtual void compile_results(json& results, json& all_results, std::string& model) = 0;
         virtual json store_result(std::vector<std::string>& names, Task_Result& result, json& results) = 0;
         virtual void consumer_go(struct ConfigGrid& config, struct ConfigMPI& config_mpi, json& tasks, int n_task, Datasets& datasets, Task_Result* result) = 0;
-        void shuffle_and_progress_bar(json& tasks);
+        // Expected cost of a task, only compared with the cost of the other tasks of the run
+        virtual double task_cost(const json& task, Datasets& datasets);
+        void order_and_progress_bar(json& tasks, Datasets& datasets);
         json producer(std::vector<std::string>& names, json& tasks, struct ConfigMPI& config_mpi, MPI_Datatype& MPI_Result);
         void consumer(Datasets& datasets, json& tasks, struct ConfigGrid& config, struct ConfigMPI& config_mpi, MPI_Datatype& MPI_Result);
         std::string get_color_rank(int rank);
@@ -26,6 +26,9 @@ namespace platform {
         bool stratified;
         int nested;
         int n_folds;
+        // Unit of work sent to the workers: "fold" (dataset, seed, fold), "combination" (..., combination)
+        // or "nested" (..., combination, nested fold)
+        std::string granularity = "fold";
         json excluded;
         std::vector<int> seeds;
     };
@@ -41,7 +41,7 @@ namespace platform {
     }
     void GridExperiment::compile_results(json& results, json& all_results, std::string& model)
     {
-        auto datasets = Datasets(false, Paths::datasets());
+        auto& datasets = Datasets::shared(false, Paths::datasets());
         nlohmann::json temp = all_results; // To restore the order of the data by dataset name
         all_results = temp;
         for (const auto& result_item : all_results.items()) {
@@ -58,7 +58,7 @@ namespace platform {
             auto leaves = torch::zeros({ data_size }, torch::kFloat64);
             auto depth = torch::zeros({ data_size }, torch::kFloat64);
             auto& dataset = datasets.getDataset(dataset_name);
-            dataset.load();
+            auto pin = dataset.pin();
             //
             // Prepare Result
             //
@@ -137,7 +137,7 @@ namespace platform {
         // Generate the hyperparameters combinations
         //
         auto& dataset = datasets.getDataset(dataset_name);
-        dataset.load();
+        auto pin = dataset.pin();
         auto [X, y] = dataset.getTensors();
         auto features = dataset.getFeatures();
         auto className = dataset.getClassName();
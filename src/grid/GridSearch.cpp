@@ -5,6 +5,7 @@
 #include "common/Paths.h"
 #include "common/Utils.h"
 #include "common/Colors.h"
+#include "common/FoldViews.hpp"
 #include "GridSearch.h"
 
 namespace platform {
@@ -74,6 +75,67 @@ namespace platform {
         }
         return results;
     }
+    std::map<std::string, double> GridSearch::estimate_fold_costs(Datasets& datasets)
+    {
+        //
+        // The time of an outer fold recorded in the previous output of the model is used when available, otherwise
+        // samples x features x combinations x nested folds, scaled to seconds with the datasets that have a time
+        //
+        std::map<std::string, double> previous;
+        try {
+            auto output = loadResults();
+            if (output.contains("results")) {
+                int nested = output.value("nested", 0);
+                double nested_ratio = nested > 0 ? static_cast<double>(config.nested) / nested : 1.0;
+                for (const auto& [name, result] : output["results"].items()) {
+                    if (result.contains("time"))
+                        previous[name] = result["time"].get<double>() * nested_ratio;
+                }
+            }
+        }
+        catch (const std::exception&) {
+            // Without a readable previous output every dataset uses the size model
+        }
+        auto grid = GridData(Paths::grid_input(config.model));
+        auto names = filterDatasets(datasets);
+        bool all_timed = std::all_of(names.begin(), names.end(), [&previous](const std::string& name) { return previous.contains(name); });
+        std::map<std::string, double> model;
+        double seconds = 0.0, units = 0.0;
+        for (const auto& name : names) {
+            n_combinations[name] = grid.getNumCombinations(name);
+            if (all_timed)
+                continue;
+            auto stats = datasets.getStats(name);
+            model[name] = static_cast<double>(stats.samples) * stats.features * n_combinations[name] * config.nested;
+            if (previous.contains(name)) {
+                seconds += previous[name];
+                units += model[name];
+            }
+        }
+        double scale = units > 0 ? seconds / units : 1.0;
+        std::map<std::string, double> costs;
+        for (const auto& name : names) {
+            costs[name] = previous.contains(name) ? previous[name] : model[name] * scale;
+        }
+        return costs;
+    }
+    double GridSearch::task_cost(const json& task, Datasets& datasets)
+    {
+        if (fold_costs.empty()) {
+            fold_costs = estimate_fold_costs(datasets);
+        }
+        auto name = task["dataset"].get<std::string>();
+        double cost = fold_costs[name];
+        if (!task.contains("group")) {
+            return cost;
+        }
+        // A task of a group is a part of the outer fold: one combination, or one training of a nested fold size
+        double trainings = std::max(1, n_combinations[name]) * config.nested;
+        if (task.contains("nested") || task.contains("refit")) {
+            return cost / trainings;
+        }
+        return cost * config.nested / trainings;
+    }
     void GridSearch::save(json& results)
     {
         std::ofstream file(Paths::grid_output(config.model));
@@ -103,8 +165,10 @@ namespace platform {
         for (const auto& result : all_results.items()) {
             // each result has the results of all the outer folds as each one were a different task
             double best_score = 0.0;
+            double total_time = 0.0;
             json best;
             for (const auto& result_fold : result.value()) {
+                total_time += result_fold["time"].get<double>();
                 double score = result_fold["score"].get<double>();
                 if (score > best_score) {
                     best_score = score;
@@ -118,7 +182,8 @@ namespace platform {
                     { "hyperparameters", combinations[best["combination"].get<int>()] },
                     { "date", get_date() + " " + get_time() },
                     { "grid", grid.getInputGrid(dataset) },
-                    { "duration", timer.translate2String(best["time"].get<double>()) }
+                    { "duration", timer.translate2String(best["time"].get<double>()) },
+                    { "time", total_time / result.value().size() } // mean seconds of an outer fold, used to order the next run
             };
             results[dataset] = json_best;
         }
@@ -141,8 +206,141 @@ namespace platform {
         results[name].push_back(json_result);
         return results;
     }
+    json GridSearch::split_task(const json& task, int group)
+    {
+        /*
+        * granularity "combination": one task per combination with the mean score of the nested folds
+        * granularity "nested": one task per combination and nested fold
+        * Both add a refit task that trains the outer fold with the best combination of the group
+        */
+        auto tasks = json::array();
+        auto n_combinations = GridData(Paths::grid_input(config.model)).getNumCombinations(task["dataset"].get<std::string>());
+        for (int idx_combination = 0; idx_combination < n_combinations; ++idx_combination) {
+            for (int n_nested_fold = 0; n_nested_fold < config.nested; ++n_nested_fold) {
+                json subtask = task;
+                subtask["combination"] = idx_combination;
+                subtask["group"] = group;
+                if (config.granularity == "combination") {
+                    tasks.push_back(subtask);
+                    break;
+                }
+                subtask["nested"] = n_nested_fold;
+                tasks.push_back(subtask);
+            }
+        }
+        json refit = task;
+        refit["group"] = group;
+        refit["refit"] = true;
+        tasks.push_back(refit);
+        return tasks;
+    }
+    std::shared_ptr<const Xaode> GridSearch::nested_counts(const torch::Tensor& X_train, const torch::Tensor& y_train) const
+    {
+        if (X_train.dtype() != torch::kInt32 || !std::dynamic_pointer_cast<XA1DE>(Models::instance()->create(config.model)))
+            return nullptr;
+        return XA1DE::countTotal(X_train, y_train);
+    }
+    void GridSearch::fit_nested(std::shared_ptr<bayesnet::BaseClassifier>& clf, const Xaode* counts, torch::Tensor& X_train, torch::Tensor& X_test, torch::Tensor& y_train, torch::Tensor& y_test, const std::vector<std::string>& features, const std::string& className, std::map<std::string, std::vector<int>>& states, const bayesnet::Smoothing_t smoothing)
+    {
+        auto xa1de = counts == nullptr ? nullptr : std::dynamic_pointer_cast<XA1DE>(clf);
+        if (xa1de == nullptr)
+            clf->fit(X_train, y_train, features, className, states, smoothing);
+        else
+            xa1de->fitSubtracting(*counts, X_train, y_train, X_test, y_test, features, className, states, smoothing);
+    }
+    GridSearch::FoldContext& GridSearch::load_fold_context(struct ConfigGrid& config, const json& task, Datasets& datasets)
+    {
+        auto dataset_name = task["dataset"].get<std::string>();
+        auto seed = task["seed"].get<int>();
+        auto n_fold = task["fold"].get<int>();
+        auto key = dataset_name + "/" + std::to_string(seed) + "/" + std::to_string(n_fold);
+        if (fold_context.key == key) {
+            return fold_context;
+        }
+        fold_context = FoldContext(); // the previous fold is released before the new one is built
+        auto& dataset = datasets.getDataset(dataset_name);
+        fold_context.pin = dataset.pin();
+        auto [X, y] = dataset.getTensors();
+        folding::Fold* fold;
+        if (config.stratified)
+            fold = new folding::StratifiedKFold(config.n_folds, y, seed);
+        else
+            fold = new folding::KFold(config.n_folds, y.size(0), seed);
+        auto [train, test] = fold->getFold(n_fold);
+        delete fold;
+        auto tensors = dataset.getFoldTensors(train, test);
+        fold_context.X_train = tensors.X_train;
+        fold_context.X_test = tensors.X_test;
+        fold_context.y_train = tensors.y_train;
+        fold_context.y_test = tensors.y_test;
+        fold_context.states = config.discretize ? tensors.states : dataset.getStates();
+        fold_context.features = dataset.getFeatures();
+        fold_context.className = dataset.getClassName();
+        folding::Fold* nested_fold;
+        if (config.stratified)
+            nested_fold = new folding::StratifiedKFold(config.nested, fold_context.y_train, seed);
+        else
+            nested_fold = new folding::KFold(config.nested, fold_context.y_train.size(0), seed);
+        fold_context.nested_folds = std::make_unique<FoldViews>(*nested_fold, config.nested, fold_context.X_train, fold_context.y_train);
+        delete nested_fold;
+        fold_context.counts = nested_counts(fold_context.X_train, fold_context.y_train);
+        fold_context.key = key;
+        return fold_context;
+    }
+    void GridSearch::consumer_go_group(struct ConfigGrid& config, struct ConfigMPI& config_mpi, json& tasks, int n_task, Datasets& datasets, Task_Result* result)
+    {
+        Timer timer;
+        timer.start();
+        json task = tasks[n_task];
+        auto dataset_name = task["dataset"].get<std::string>();
+        auto combinations = GridData(Paths::grid_input(config.model)).getGrid(dataset_name);
+        auto& context = load_fold_context(config, task, datasets);
+        int idx_combination = task["combination"].get<int>();
+        double score = 0.0;
+        if (task.contains("refit")) {
+            //
+            // Train the outer fold with the best combination of the group (none if no combination scored above 0)
+            //
+            json hyperparam_line = idx_combination >= 0 ? combinations[idx_combination] : json();
+            auto hyperparameters = platform::HyperParameters(datasets.getNames(), hyperparam_line);
+            auto clf = Models::instance()->create(config.model);
+            auto valid = clf->getValidHyperparameters();
+            hyperparameters.check(valid, dataset_name);
+            clf->setHyperparameters(hyperparam_line);
+            clf->fit(context.X_train, context.y_train, context.features, context.className, context.states, smooth_type);
+            score = clf->score(context.X_test, context.y_test);
+        } else {
+            //
+            // Evaluate the combination on one nested fold or on all of them
+            //
+            auto hyperparameters = platform::HyperParameters(datasets.getNames(), combinations[idx_combination]);
+            int first = task.contains("nested") ? task["nested"].get<int>() : 0;
+            int last = task.contains("nested") ? first + 1 : config.nested;
+            for (int n_nested_fold = first; n_nested_fold < last; n_nested_fold++) {
+                auto [X_nested_train, X_nested_test, y_nested_train, y_nested_test] = context.nested_folds->getFold(n_nested_fold);
+                auto clf = Models::instance()->create(config.model);
+                auto valid = clf->getValidHyperparameters();
+                hyperparameters.check(valid, dataset_name);
+                clf->setHyperparameters(hyperparameters.get(dataset_name));
+                fit_nested(clf, context.counts.get(), X_nested_train, X_nested_test, y_nested_train, y_nested_test, context.features, context.className, context.states, smooth_type);
+                score += clf->score(X_nested_test, y_nested_test);
+            }
+            score /= last - first;
+        }
+        result->idx_dataset = task["idx_dataset"].get<int>();
+        result->idx_combination = idx_combination;
+        result->score = score;
+        result->n_fold = task["fold"].get<int>();
+        result->time = timer.getDuration();
+        result->process = config_mpi.rank;
+        result->task = n_task;
+    }
     void GridSearch::consumer_go(struct ConfigGrid& config, struct ConfigMPI& config_mpi, json& tasks, int n_task, Datasets& datasets, Task_Result* result)
     {
+        if (tasks[n_task].contains("group")) {
+            consumer_go_group(config, config_mpi, tasks, n_task, datasets, result);
+            return;
+        }
         //
         // initialize
         //
@@ -168,7 +366,7 @@ namespace platform {
         //
         auto& dataset = datasets.getDataset(dataset_name);
         auto combinations = grid.getGrid(dataset_name);
-        dataset.load();
+        auto pin = dataset.pin();
         auto [X, y] = dataset.getTensors();
         auto features = dataset.getFeatures();
         auto className = dataset.getClassName();
@@ -183,29 +381,30 @@ namespace platform {
         auto [train, test] = fold->getFold(n_fold);
         auto [X_train, X_test, y_train, y_test] = dataset.getTrainTestTensors(train, test);
         auto states = dataset.getStates(); // Get the states of the features Once they are discretized
-        float best_fold_score = 0.0;
-        int best_idx_combination = -1;
-        json best_fold_hyper;
-        for (int idx_combination = 0; idx_combination < combinations.size(); ++idx_combination) {
-            auto hyperparam_line = combinations[idx_combination];
-            auto hyperparameters = platform::HyperParameters(datasets.getNames(), hyperparam_line);
-            folding::Fold* nested_fold;
-            if (config.stratified)
-                nested_fold = new folding::StratifiedKFold(config.nested, y_train, seed);
-            else
-                nested_fold = new folding::KFold(config.nested, y_train.size(0), seed);
-            double score = 0.0;
-            for (int n_nested_fold = 0; n_nested_fold < config.nested; n_nested_fold++) {
-                //
-                // Nested level fold
-                //
-                auto [train_nested, test_nested] = nested_fold->getFold(n_nested_fold);
-                auto train_nested_t = torch::tensor(train_nested);
-                auto test_nested_t = torch::tensor(test_nested);
-                auto X_nested_train = X_train.index({ "...", train_nested_t });
-                auto y_nested_train = y_train.index({ train_nested_t });
-                auto X_nested_test = X_train.index({ "...", test_nested_t });
-                auto y_nested_test = y_train.index({ test_nested_t });
+        //
+        // The nested folds don't depend on the hyperparameters, they are built once and shared
+        // by every combination
+        //
+        folding::Fold* nested_fold;
+        if (config.stratified)
+            nested_fold = new folding::StratifiedKFold(config.nested, y_train, seed);
+        else
+            nested_fold = new folding::KFold(config.nested, y_train.size(0), seed);
+        auto nested_folds = FoldViews(*nested_fold, config.nested, X_train, y_train);
+        delete nested_fold;
+        auto counts = nested_counts(X_train, y_train);
+        //
+        // Every nested fold is taken once and all the combinations are evaluated on it, so only the
+        // train split of one nested fold is materialized at a time
+        //
+        std::vector<double> scores(combinations.size(), 0.0);
+        for (int n_nested_fold = 0; n_nested_fold < config.nested; n_nested_fold++) {
+            //
+            // Nested level fold
+            //
+            auto [X_nested_train, X_nested_test, y_nested_train, y_nested_test] = nested_folds.getFold(n_nested_fold);
+            for (int idx_combination = 0; idx_combination < combinations.size(); ++idx_combination) {
+                auto hyperparameters = platform::HyperParameters(datasets.getNames(), combinations[idx_combination]);
                 //
                 // Build Classifier with selected hyperparameters
                 //
@@ -216,18 +415,22 @@ namespace platform {
                 //
                 // Train model
                 //
-                clf->fit(X_nested_train, y_nested_train, features, className, states, smooth);
+                fit_nested(clf, counts.get(), X_nested_train, X_nested_test, y_nested_train, y_nested_test, features, className, states, smooth);
                 //
                 // Test model
                 //
-                score += clf->score(X_nested_test, y_nested_test);
+                scores[idx_combination] += clf->score(X_nested_test, y_nested_test);
             }
-            delete nested_fold;
-            score /= config.nested;
+        }
+        float best_fold_score = 0.0;
+        int best_idx_combination = -1;
+        json best_fold_hyper;
+        for (int idx_combination = 0; idx_combination < combinations.size(); ++idx_combination) {
+            double score = scores[idx_combination] / config.nested;
             if (score > best_fold_score) {
                 best_fold_score = score;
                 best_idx_combination = idx_combination;
-                best_fold_hyper = hyperparam_line;
+                best_fold_hyper = combinations[idx_combination];
             }
         }
         delete fold;
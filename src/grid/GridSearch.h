@@ -2,12 +2,15 @@
 #define GRIDSEARCH_H
 #include <string>
 #include <map>
+#include <memory>
 #include <mpi.h>
 #include <nlohmann/json.hpp>
 #include <folding.hpp>
 #include "common/Datasets.h"
 #include "common/Timer.hpp"
 #include "main/HyperParameters.h"
+#include "common/FoldViews.hpp"
+#include "experimental_clfs/Xaode.hpp"
 #include "GridData.h"
 #include "GridBase.h"
 #include "bayesnet/network/Network.h"
@@ -28,6 +31,31 @@ namespace platform {
         void compile_results(json& results, json& all_results, std::string& model);
         json store_result(std::vector<std::string>& names, Task_Result& result, json& results);
         void consumer_go(struct ConfigGrid& config, struct ConfigMPI& config_mpi, json& tasks, int n_task, Datasets& datasets, Task_Result* result);
+        json split_task(const json& task, int group) override;
+        double task_cost(const json& task, Datasets& datasets) override;
+        std::map<std::string, double> estimate_fold_costs(Datasets& datasets);
+        std::map<std::string, double> fold_costs; // expected seconds of an outer fold of each dataset
+        std::map<std::string, int> n_combinations;
+        // Outer fold shared by the evaluation and refit tasks of a group, kept while the worker gets tasks of the same fold.
+        // The producer gives a worker the ready tasks of its last group first, so one context per worker is enough
+        struct FoldContext {
+            std::string key;
+            Dataset::Pin pin;
+            torch::Tensor X_train, X_test, y_train, y_test;
+            std::map<std::string, std::vector<int>> states;
+            std::vector<std::string> features;
+            std::string className;
+            std::unique_ptr<FoldViews> nested_folds;
+            std::shared_ptr<const Xaode> counts;
+        };
+        // Counts of the outer train samples the nested folds of count-based models (XA1DE) are derived from.
+        // The nested folds are views of the outer train tensors, so they don't depend on the split. Null if
+        // the model doesn't count or the samples aren't discrete
+        std::shared_ptr<const Xaode> nested_counts(const torch::Tensor& X_train, const torch::Tensor& y_train) const;
+        static void fit_nested(std::shared_ptr<bayesnet::BaseClassifier>& clf, const Xaode* counts, torch::Tensor& X_train, torch::Tensor& X_test, torch::Tensor& y_train, torch::Tensor& y_test, const std::vector<std::string>& features, const std::string& className, std::map<std::string, std::vector<int>>& states, const bayesnet::Smoothing_t smoothing);
+        FoldContext& load_fold_context(struct ConfigGrid& config, const json& task, Datasets& datasets);
+        void consumer_go_group(struct ConfigGrid& config, struct ConfigMPI& config_mpi, json& tasks, int n_task, Datasets& datasets, Task_Result* result);
+        FoldContext fold_context;
     };
 } /* namespace platform */
 #endif
\ No newline at end of file
@@ -11,14 +11,14 @@ namespace platform {
     void ArgumentsExperiment::add_arguments()
     {
         auto env = platform::DotEnv();
-        auto datasets = platform::Datasets(false, platform::Paths::datasets());
+        auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
         auto& group = arguments.add_mutually_exclusive_group(true);
 
         group.add_argument("-d", "--dataset")
             .help("Dataset file name: " + datasets.toString())
             .default_value("all")
             .action([](const std::string& value) {
-            auto datasets = platform::Datasets(false, platform::Paths::datasets());
+            auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
             static std::vector<std::string> choices_datasets(datasets.getNames());
             choices_datasets.push_back("all");
             if (find(choices_datasets.begin(), choices_datasets.end(), value) != choices_datasets.end()) {
@@ -84,6 +84,20 @@ namespace platform {
             if (type == experiment_t::NORMAL) {
                 arguments.add_argument("--generate-fold-files").help("generate fold information in datasets_experiment folder").default_value(false).implicit_value(true);
                 arguments.add_argument("--graph").help("generate graphviz dot files with the model").default_value(false).implicit_value(true);
+                arguments.add_argument("--jobs").help("Number of folds trained concurrently").default_value(1).scan<'i', int>().action([](const std::string& value) {
+                    try {
+                        auto n = stoi(value);
+                        if (n < 1) {
+                            throw std::runtime_error("Number of jobs must be greater than 0");
+                        }
+                        return n;
+                    }
+                    catch (const runtime_error& err) {
+                        throw std::runtime_error(err.what());
+                    }
+                    catch (...) {
+                        throw std::runtime_error("Number of jobs must be an integer");
+                    }});
             }
     }
     void ArgumentsExperiment::parse_args(int argc, char** argv)
@@ -141,9 +155,11 @@ namespace platform {
             if (type == experiment_t::NORMAL) {
                 graph = arguments.get<bool>("graph");
                 generate_fold_files = arguments.get<bool>("generate-fold-files");
+                jobs = arguments.get<int>("jobs");
             } else {
                 graph = false;
                 generate_fold_files = false;
+                jobs = 1;
             }
         }
         catch (const exception& err) {
@@ -151,7 +167,7 @@ namespace platform {
             cerr << arguments;
             exit(1);
         }
-        auto datasets = platform::Datasets(false, platform::Paths::datasets());
+        auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
         if (datasets_file != "") {
             ifstream catalog(datasets_file);
             if (catalog.is_open()) {
@@ -257,6 +273,7 @@ namespace platform {
         experiment.setNoTrainScore(no_train_score);
         experiment.setGenerateFoldFiles(generate_fold_files);
         experiment.setGraph(graph);
+        experiment.setJobs(jobs);
         return experiment;
     }
 }
\ No newline at end of file
@@ -36,6 +36,7 @@ namespace platform {
         std::vector<std::string> filesToTest;
         platform::HyperParameters test_hyperparams;
         int n_folds;
+        int jobs;
     };
 }
 #endif
\ No newline at end of file
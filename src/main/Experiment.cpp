@@ -1,3 +1,8 @@
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include "common/Datasets.h"
 #include "reports/ReportConsole.h"
 #include "common/Paths.h"
@@ -69,6 +74,11 @@ namespace platform {
         auto clf = Models::instance()->create(result.getModel());
         auto version = clf->getVersion();
         std::cout << Colors::BLUE() << " Using " << result.getModel() << " ver. " << version << std::endl << std::endl;
+        if (n_jobs > 1 && dynamic_cast<pywrap::PyClassifier*>(clf.get()) != nullptr) {
+            // The Python interpreter can't train several models at the same time
+            std::cout << Colors::YELLOW() << " Python classifiers are trained sequentially, ignoring --jobs " << n_jobs << Colors::RESET() << std::endl << std::endl;
+            n_jobs = 1;
+        }
         if (!quiet) {
             std::cout << Colors::GREEN() << " Status Meaning" << std::endl;
             std::cout << " ------ --------------------------------" << Colors::RESET() << std::endl;
@@ -158,20 +168,88 @@ namespace platform {
         file << output.dump(4);
         file.close();
     }
+    Experiment::FoldResult Experiment::train_fold(const Dataset& dataset, FoldTask& task, const json& hyperparameters_dataset, score_t score, bool show_progress, const Xaode* counts)
+    {
+        FoldResult outcome;
+        Timer train_timer, test_timer;
+        auto nfold = task.nfold;
+        auto seed = task.seed;
+        auto features = dataset.getFeatures();
+        auto className = dataset.getClassName();
+        auto labels = dataset.getLabels();
+        int num_classes = dataset.getNClasses();
+        auto clf = Models::instance()->create(result.getModel());
+        if (show_progress)
+            showProgress(nfold + 1, getColor(clf->getStatus()), "-");
+        outcome.version = clf->getVersion();
+        clf->setHyperparameters(hyperparameters_dataset);
+        //
+        // Split train - test dataset
+        //
+        train_timer.start();
+        auto [X_train, X_test, y_train, y_test, states] = dataset.getFoldTensors(task.train, task.test);
+        if (generate_fold_files)
+            generate_files(dataset.getName(), discretized, stratified, seed, nfold, X_train, y_train, X_test, y_test, task.train, task.test);
+        if (show_progress)
+            showProgress(nfold + 1, getColor(clf->getStatus()), "a");
+        //
+        // Train model
+        //
+        auto xa1de = counts == nullptr ? nullptr : std::dynamic_pointer_cast<XA1DE>(clf);
+        if (xa1de == nullptr)
+            clf->fit(X_train, y_train, features, className, states, smooth_type);
+        else
+            xa1de->fitSubtracting(*counts, X_train, y_train, X_test, y_test, features, className, states, smooth_type);
+        auto clf_notes = clf->getNotes();
+        std::transform(clf_notes.begin(), clf_notes.end(), std::back_inserter(outcome.notes), [seed, nfold](const std::string& note)
+            { return "Seed: " + std::to_string(seed) + " Fold: " + std::to_string(nfold) + ": " + note; });
+        outcome.nodes = clf->getNumberOfNodes();
+        outcome.edges = clf->getNumberOfEdges();
+        outcome.num_states = clf->getNumberOfStates();
+        outcome.train_time = train_timer.getDuration();
+        //
+        // Score train
+        //
+        if (!no_train_score) {
+            if (show_progress)
+                showProgress(nfold + 1, getColor(clf->getStatus()), "b");
+            auto y_proba_train = clf->predict_proba(X_train);
+            Scores scores(y_train, y_proba_train, num_classes, labels);
+            outcome.score_train = score == score_t::ACCURACY ? scores.accuracy() : scores.auc();
+            if (discretized)
+                outcome.confusion_matrix_train = scores.get_confusion_matrix_json(true);
+        }
+        //
+        // Test model
+        //
+        if (show_progress)
+            showProgress(nfold + 1, getColor(clf->getStatus()), "c");
+        test_timer.start();
+        auto y_proba_test = clf->predict_proba(X_test);
+        Scores scores(y_test, y_proba_test, num_classes, labels);
+        outcome.score_test = score == score_t::ACCURACY ? scores.accuracy() : scores.auc();
+        outcome.test_time = test_timer.getDuration();
+        if (discretized)
+            outcome.confusion_matrix = scores.get_confusion_matrix_json(true);
+        outcome.status = clf->getStatus();
+        if (graph) {
+            for (const auto& line : clf->graph()) {
+                outcome.graph += line + "\n";
+            }
+        }
+        return outcome;
+    }
     void Experiment::cross_validation(const std::string& fileName)
     {
         //
         // Load dataset and prepare data
         //
-        auto datasets = Datasets(discretized, Paths::datasets(), discretization_algo);
+        auto& datasets = Datasets::shared(discretized, Paths::datasets(), discretization_algo);
         auto& dataset = datasets.getDataset(fileName);
-        dataset.load();
+        auto pin = dataset.pin(); // the folds are read by the workers
         auto [X, y] = dataset.getTensors(); // Only need y for folding
-        auto features = dataset.getFeatures();
         auto n_features = dataset.getNFeatures();
         auto n_samples = dataset.getNSamples();
-        auto className = dataset.getClassName();
-        auto labels = dataset.getLabels();
         int num_classes = dataset.getNClasses();
         if (!quiet) {
             std::cout << " " << setw(5) << n_samples << " " << setw(5) << n_features << " " << setw(3) << num_classes << flush;
@@ -180,8 +258,20 @@ namespace platform {
         // Prepare Result
         //
         auto partial_result = PartialResult();
+        auto hyperparameters_dataset = hyperparameters.get(fileName);
         partial_result.setSamples(n_samples).setFeatures(n_features).setClasses(num_classes);
-        partial_result.setHyperparameters(hyperparameters.get(fileName));
+        partial_result.setHyperparameters(hyperparameters_dataset);
+        auto model = Models::instance()->create(result.getModel());
+        hyperparameters.check(model->getValidHyperparameters(), fileName);
+        //
+        // Count-based models get the model of every fold from the counts of the whole dataset minus the
+        // fold test samples, provided the fold tensors don't depend on the split: discretized datasets
+        // without numeric features
+        //
+        std::shared_ptr<const Xaode> counts;
+        auto& numeric = dataset.getNumericFeatures();
+        if (discretized && std::none_of(numeric.begin(), numeric.end(), [](bool value) { return value; }) && std::dynamic_pointer_cast<XA1DE>(model))
+            counts = XA1DE::countTotal(X.to(torch::kInt32), y);
         //
         // Initialize results std::vectors
         //
@@ -197,110 +287,149 @@ namespace platform {
         json confusion_matrices_train = json::array();
         std::vector<std::string> notes;
         std::vector<std::string> graphs;
-        Timer train_timer, test_timer, seed_timer;
-        int item = 0;
-        bool first_seed = true;
+        Timer seed_timer;
+        double seed_score_sum = 0.0;
+        auto score = parse_score();
         //
-        // Loop over random seeds
+        // Build the (seed, fold) units of work in the order their results have to be stored
         //
-        auto score = parse_score();
+        std::vector<FoldTask> tasks;
         for (auto seed : randomSeeds) {
-            seed_timer.start();
-            double seed_score_sum = 0.0;
-            if (!quiet) {
-                string prefix = " ";
-                if (!first_seed) {
-                    prefix = "\n" + string(22 + max_name, ' ');
-                }
-                std::cout << prefix << setw(4) << right << seed << " " << flush;
-                first_seed = false;
-            }
             folding::Fold* fold;
             if (stratified)
                 fold = new folding::StratifiedKFold(nfolds, y, seed);
             else
                 fold = new folding::KFold(nfolds, n_samples, seed);
-            //
-            // Loop over folds
-            //
             for (int nfold = 0; nfold < nfolds; nfold++) {
-                auto clf = Models::instance()->create(result.getModel());
-                if (!quiet)
-                    showProgress(nfold + 1, getColor(clf->getStatus()), "-");
-                setModelVersion(clf->getVersion());
-                auto valid = clf->getValidHyperparameters();
-                hyperparameters.check(valid, fileName);
-                clf->setHyperparameters(hyperparameters.get(fileName));
-                //
-                // Split train - test dataset
-                //
-                train_timer.start();
                 auto [train, test] = fold->getFold(nfold);
-                auto [X_train, X_test, y_train, y_test] = dataset.getTrainTestTensors(train, test);
-                auto states = dataset.getStates(); // Get the states of the features Once they are discretized
-                if (generate_fold_files)
-                    generate_files(fileName, discretized, stratified, seed, nfold, X_train, y_train, X_test, y_test, train, test);
-                if (!quiet)
-                    showProgress(nfold + 1, getColor(clf->getStatus()), "a");
-                //
-                // Train model
-                //
-                clf->fit(X_train, y_train, features, className, states, smooth_type);
-                auto clf_notes = clf->getNotes();
-                std::transform(clf_notes.begin(), clf_notes.end(), std::back_inserter(notes), [seed, nfold](const std::string& note)
-                    { return "Seed: " + std::to_string(seed) + " Fold: " + std::to_string(nfold) + ": " + note; });
-                nodes[item] = clf->getNumberOfNodes();
-                edges[item] = clf->getNumberOfEdges();
-                num_states[item] = clf->getNumberOfStates();
-                train_time[item] = train_timer.getDuration();
-                double score_train_value = 0.0;
-                //
-                // Score train
-                //
-                if (!no_train_score) {
-                    if (!quiet)
-                        showProgress(nfold + 1, getColor(clf->getStatus()), "b");
-                    auto y_proba_train = clf->predict_proba(X_train);
-                    Scores scores(y_train, y_proba_train, num_classes, labels);
-                    score_train_value = score == score_t::ACCURACY ? scores.accuracy() : scores.auc();
-                    if (discretized)
-                        confusion_matrices_train.push_back(scores.get_confusion_matrix_json(true));
+                tasks.push_back({ seed, nfold, train, test });
+            }
+            delete fold;
+        }
+        //
+        // With more than one job, the tasks are trained by a bounded pool of workers while
+        // this thread collects the results in the tasks order, so the output is the same as
+        // in the sequential execution
+        //
+        int n_workers = n_jobs > 1 ? std::min(n_jobs, static_cast<int>(tasks.size())) : 0;
+        std::vector<FoldResult> outcomes(tasks.size());
+        std::vector<bool> finished(tasks.size(), false);
+        std::atomic<size_t> next_task{ 0 };
+        std::mutex mtx;
+        std::condition_variable cv;
+        auto worker = [&]() {
+            size_t idx;
+            while ((idx = next_task++) < tasks.size()) {
+                FoldResult outcome;
+                try {
+                    outcome = train_fold(dataset, tasks[idx], hyperparameters_dataset, score, false, counts.get());
                 }
-                //
-                // Test model
-                //
-                if (!quiet)
-                    showProgress(nfold + 1, getColor(clf->getStatus()), "c");
-                test_timer.start();
-                // auto y_predict = clf->predict(X_test);
-                auto y_proba_test = clf->predict_proba(X_test);
-                Scores scores(y_test, y_proba_test, num_classes, labels);
-                auto score_test_value = score == score_t::ACCURACY ? scores.accuracy() : scores.auc();
-                test_time[item] = test_timer.getDuration();
-                score_train[item] = score_train_value;
-                score_test[item] = score_test_value;
-                seed_score_sum += score_test_value;
-                if (discretized)
-                    confusion_matrices.push_back(scores.get_confusion_matrix_json(true));
-                if (!quiet)
-                    std::cout << "\b\b\b, " << flush;
-                //
-                // Store results and times in std::vector
-                //
-                partial_result.addScoreTrain(score_train_value);
-                partial_result.addScoreTest(score_test_value);
-                partial_result.addTimeTrain(train_time[item].item<double>());
-                partial_result.addTimeTest(test_time[item].item<double>());
-                item++;
-                if (graph) {
-                    std::string result = "";
-                    for (const auto& line : clf->graph()) {
-                        result += line + "\n";
+                catch (...) {
+                    outcome.error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    outcomes[idx] = std::move(outcome);
+                    finished[idx] = true;
+                }
+                cv.notify_all();
+            }
+            };
+        //
+        // The workers are joined when this scope is left, also by an exception. The libtorch intra-op threads are
+        // a process setting: it is set here, before the workers start, to give each job its share of the cores so
+        // n_jobs jobs don't oversubscribe the machine, and restored once all of them are joined
+        //
+        struct Workers {
+            std::atomic<size_t>& next_task;
+            size_t n_tasks;
+            int torch_threads = -1; // threads to restore, -1 if they weren't changed
+            std::vector<std::thread> threads;
+            void start(int n_workers, const std::function<void()>& worker)
+            {
+                int hardware = static_cast<int>(std::thread::hardware_concurrency());
+                torch_threads = torch::get_num_threads();
+                torch::set_num_threads(std::max(1, hardware / n_workers));
+                for (int i = 0; i < n_workers; ++i) {
+                    threads.emplace_back(worker);
+                }
+            }
+            void stop()
+            {
+                next_task = n_tasks;
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                threads.clear();
+                if (torch_threads > 0) {
+                    torch::set_num_threads(torch_threads);
+                    torch_threads = -1;
+                }
+            }
+            ~Workers() { stop(); }
+        } workers{ next_task, tasks.size() };
+        if (n_workers > 0) {
+            workers.start(n_workers, worker);
+        }
+        //
+        // Loop over random seeds and folds
+        //
+        for (size_t item = 0; item < tasks.size(); ++item) {
+            auto& task = tasks[item];
+            if (task.nfold == 0) {
+                seed_timer.start();
+                seed_score_sum = 0.0;
+                if (!quiet) {
+                    string prefix = " ";
+                    if (item != 0) {
+                        prefix = "\n" + string(22 + max_name, ' ');
                     }
-                    graphs.push_back(result);
+                    std::cout << prefix << setw(4) << right << task.seed << " " << flush;
                 }
             }
-            if (!quiet) {
+            FoldResult outcome;
+            if (n_workers == 0) {
+                outcome = train_fold(dataset, task, hyperparameters_dataset, score, !quiet, counts.get());
+            } else {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return finished[item]; });
+                outcome = std::move(outcomes[item]);
+                lock.unlock();
+                if (outcome.error) {
+                    workers.stop();
+                    std::rethrow_exception(outcome.error);
+                }
+                if (!quiet)
+                    showProgress(task.nfold + 1, getColor(outcome.status), "-");
+            }
+            if (!quiet)
+                std::cout << "\b\b\b, " << flush;
+            //
+            // Store results and times in std::vector
+            //
+            setModelVersion(outcome.version);
+            notes.insert(notes.end(), outcome.notes.begin(), outcome.notes.end());
+            nodes[item] = outcome.nodes;
+            edges[item] = outcome.edges;
+            num_states[item] = outcome.num_states;
+            train_time[item] = outcome.train_time;
+            test_time[item] = outcome.test_time;
+            score_train[item] = outcome.score_train;
+            score_test[item] = outcome.score_test;
+            seed_score_sum += outcome.score_test;
+            if (discretized) {
+                confusion_matrices.push_back(outcome.confusion_matrix);
+                if (!no_train_score)
+                    confusion_matrices_train.push_back(outcome.confusion_matrix_train);
+            }
+            partial_result.addScoreTrain(outcome.score_train);
+            partial_result.addScoreTest(outcome.score_test);
+            partial_result.addTimeTrain(outcome.train_time);
+            partial_result.addTimeTest(outcome.test_time);
+            if (graph) {
+                graphs.push_back(outcome.graph);
+            }
+            if (task.nfold == nfolds - 1 && !quiet) {
                 seed_timer.stop();
                 std::cout << "end. " << std::setw(10) << std::right << seed_timer.getDurationString();
                 if (randomSeeds.size() > 1) {
@@ -308,8 +437,9 @@ namespace platform {
                     std::cout << " " << Colors::YELLOW() << std::setw(9) << std::right << std::fixed << std::setprecision(7) << seed_score_mean << Colors::RESET();
                 }
             }
-            delete fold;
+            outcomes[item] = FoldResult(); // release the memory of the stored result
         }
+        workers.stop();
         // Show Results
         auto score_mean = torch::mean(score_test).item<double>();
         if (!quiet)
@@ -3,11 +3,14 @@
 #include <torch/torch.h>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <exception>
 #include <folding.hpp>
 #include "bayesnet/BaseClassifier.h"
 #include "HyperParameters.h"
+#include "common/Dataset.h"
 #include "results/Result.h"
 #include "bayesnet/network/Network.h"
+#include "experimental_clfs/Xaode.hpp"
 
 namespace platform {
     using json = nlohmann::ordered_json;
@@ -40,9 +43,11 @@ namespace platform {
         bool isDiscretized() const { return discretized; }
         bool isStratified() const { return stratified; }
         bool isQuiet() const { return quiet; }
+        int getJobs() const { return n_jobs; }
         std::string getSmoothStrategy() const { return smooth_strategy; }
         int getNFolds() const { return nfolds; }
         std::vector<int> getRandomSeeds() const { return randomSeeds; }
+        Result& getResult() { return result; }
         void cross_validation(const std::string& fileName);
         void go();
         void saveResult(const std::string& path);
@@ -54,7 +59,28 @@ namespace platform {
         void setNoTrainScore(bool no_train_score) { this->no_train_score = no_train_score; }
         void setGenerateFoldFiles(bool generate_fold_files) { this->generate_fold_files = generate_fold_files; }
         void setGraph(bool graph) { this->graph = graph; }
+        void setJobs(int n_jobs) { this->n_jobs = n_jobs; }
     private:
+        // Unit of work of the cross validation: one fold of one seed
+        struct FoldTask {
+            int seed;
+            int nfold;
+            std::vector<int> train;
+            std::vector<int> test;
+        };
+        // Outcome of a FoldTask, stored in the results in the same order as the tasks were created
+        struct FoldResult {
+            double score_train{ 0.0 }, score_test{ 0.0 }, train_time{ 0.0 }, test_time{ 0.0 };
+            double nodes{ 0.0 }, edges{ 0.0 }, num_states{ 0.0 };
+            bayesnet::status_t status{ bayesnet::NORMAL };
+            std::string version;
+            std::vector<std::string> notes;
+            std::string graph;
+            json confusion_matrix, confusion_matrix_train;
+            std::exception_ptr error;
+        };
+        // counts, if not null, are the counts of the whole dataset the fold model is derived from (XA1DE)
+        FoldResult train_fold(const Dataset& dataset, FoldTask& task, const json& hyperparameters_dataset, score_t score, bool show_progress, const Xaode* counts);
         score_t parse_score() const;
         Result result;
         bool discretized{ false }, stratified{ false }, generate_fold_files{ false }, graph{ false }, quiet{ false }, no_train_score{ false };
@@ -66,6 +92,7 @@ namespace platform {
         bayesnet::Smoothing_t smooth_type{ bayesnet::Smoothing_t::NONE };
         HyperParameters hyperparameters;
         int nfolds{ 0 };
+        int n_jobs{ 1 }; // number of folds trained concurrently in cross_validation
         int max_name{ 7 }; // max length of dataset name for formatting (default 7)
     };
 }
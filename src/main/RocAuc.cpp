@@ -1,69 +1,87 @@
-#include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <thread>
 #include <utility>
 #include "RocAuc.h"
-#include "common/TensorUtils.hpp" // tensorToVector
 namespace platform {
+    // Below this number of scores the classes are computed sequentially
+    const size_t parallel_threshold = 20000;
 
     double RocAuc::compute(const torch::Tensor& y_proba, const torch::Tensor& labels)
     {
-        size_t nClasses = y_proba.size(1);
-        // In binary classification problem there's no need to calculate the average of the AUCs
-        if (nClasses == 2)
-            nClasses = 1;
-        size_t nSamples = y_proba.size(0);
-        y_test = tensorToVector(labels);
-        std::vector<double> aucScores(nClasses, 0.0);
-        for (size_t classIdx = 0; classIdx < nClasses; ++classIdx) {
-            scoresAndLabels.clear();
-            for (size_t i = 0; i < nSamples; ++i) {
-                scoresAndLabels.emplace_back(y_proba[i][classIdx].item<float>(), y_test[i] == classIdx ? 1 : 0);
-            }
-            aucScores[classIdx] = compute_common(nSamples, classIdx);
-        }
-        return std::accumulate(aucScores.begin(), aucScores.end(), 0.0) / nClasses;
+        auto proba = y_proba.to(torch::kDouble).contiguous();
+        auto y_test = labels.to(torch::kInt32).contiguous();
+        return compute(proba.data_ptr<double>(), y_test.data_ptr<int>(), proba.size(0), proba.size(1));
     }
     double RocAuc::compute(const std::vector<std::vector<double>>& y_proba, const std::vector<int>& labels)
     {
-        y_test = labels;
+        size_t nSamples = y_proba.size();
         size_t nClasses = y_proba[0].size();
+        std::vector<double> proba;
+        proba.reserve(nSamples * nClasses);
+        for (const auto& row : y_proba) {
+            proba.insert(proba.end(), row.begin(), row.end());
+        }
+        return compute(proba.data(), labels.data(), nSamples, nClasses);
+    }
+    double RocAuc::compute(const double* y_proba, const int* y_test, size_t nSamples, size_t nClasses)
+    {
+        if (nSamples == 0 || nClasses == 0) return 0;
         // In binary classification problem there's no need to calculate the average of the AUCs
-        if (nClasses == 2)
-            nClasses = 1;
-        size_t nSamples = y_proba.size();
-        std::vector<double> aucScores(nClasses, 0.0);
-        for (size_t classIdx = 0; classIdx < nClasses; ++classIdx) {
-            scoresAndLabels.clear();
-            for (size_t i = 0; i < nSamples; ++i) {
-                scoresAndLabels.emplace_back(y_proba[i][classIdx], labels[i] == classIdx ? 1 : 0);
+        size_t nScores = nClasses == 2 ? 1 : nClasses;
+        std::vector<double> aucScores(nScores, 0.0);
+        size_t n_threads = 1;
+        if (nScores > 1 && nSamples * nScores >= parallel_threshold) {
+            n_threads = std::min<size_t>(nScores, std::max(1u, std::thread::hardware_concurrency()));
+        }
+        if (n_threads == 1) {
+            for (size_t classIdx = 0; classIdx < nScores; ++classIdx) {
+                aucScores[classIdx] = class_auc(y_proba, y_test, nSamples, nClasses, classIdx);
+            }
+        } else {
+            std::atomic<size_t> next{ 0 };
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < n_threads; ++t) {
+                workers.emplace_back([&]() {
+                    for (size_t classIdx = next++; classIdx < nScores; classIdx = next++) {
+                        aucScores[classIdx] = class_auc(y_proba, y_test, nSamples, nClasses, classIdx);
+                    }
+                    });
+            }
+            for (auto& worker : workers) {
+                worker.join();
             }
-            aucScores[classIdx] = compute_common(nSamples, classIdx);
         }
-        return std::accumulate(aucScores.begin(), aucScores.end(), 0.0) / nClasses;
+        return std::accumulate(aucScores.begin(), aucScores.end(), 0.0) / nScores;
     }
-    double RocAuc::compute_common(size_t nSamples, size_t classIdx)
+    double RocAuc::class_auc(const double* y_proba, const int* y_test, size_t nSamples, size_t nClasses, size_t classIdx)
     {
-        std::sort(scoresAndLabels.begin(), scoresAndLabels.end(), std::greater<>());
-        std::vector<double> tpr, fpr;
-        double tp = 0, fp = 0;
-        double totalPos = std::count(y_test.begin(), y_test.end(), classIdx);
-        double totalNeg = nSamples - totalPos;
-        if (totalPos == 0 || totalNeg == 0) return 0.5; // neutral AUC
-
-        for (const auto& [score, label] : scoresAndLabels) {
-            if (label == 1) {
-                tp += 1;
-            } else {
-                fp += 1;
-            }
-            tpr.push_back(tp / totalPos);
-            fpr.push_back(fp / totalNeg);
+        // Mann-Whitney formulation: fraction of (positive, negative) pairs ordered correctly,
+        // computed with a single sort and a pass over the groups of tied scores
+        std::vector<std::pair<double, int>> scoresAndLabels(nSamples);
+        for (size_t i = 0; i < nSamples; ++i) {
+            scoresAndLabels[i] = { y_proba[i * nClasses + classIdx], y_test[i] == static_cast<int>(classIdx) ? 1 : 0 };
         }
-        double auc = 0.0;
-        for (size_t i = 1; i < tpr.size(); ++i) {
-            auc += 0.5 * (fpr[i] - fpr[i - 1]) * (tpr[i] + tpr[i - 1]);
+        std::sort(scoresAndLabels.begin(), scoresAndLabels.end());
+        double totalPos = 0, totalNeg = 0, correct = 0;
+        for (size_t begin = 0; begin < nSamples;) {
+            double pos = 0, neg = 0;
+            size_t end = begin;
+            for (; end < nSamples && scoresAndLabels[end].first == scoresAndLabels[begin].first; ++end) {
+                if (scoresAndLabels[end].second == 1) {
+                    pos += 1;
+                } else {
+                    neg += 1;
+                }
+            }
+            // Positives of the group are above every negative seen so far and tie with the group ones
+            correct += pos * (totalNeg + 0.5 * neg);
+            totalPos += pos;
+            totalNeg += neg;
+            begin = end;
         }
-        return auc;
+        if (totalPos == 0 || totalNeg == 0) return 0.5; // neutral AUC
+        return correct / (totalPos * totalNeg);
     }
-}
\ No newline at end of file
+}
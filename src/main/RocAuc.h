@@ -12,10 +12,11 @@ namespace platform {
         RocAuc() = default;
         double compute(const std::vector<std::vector<double>>& y_proba, const std::vector<int>& y_test);
         double compute(const torch::Tensor& y_proba, const torch::Tensor& y_test);
+        // One vs rest AUC averaged over the classes (only class 0 in binary problems) of a row major
+        // nSamples x nClasses probability matrix. Tied scores count as half a correct ordering
+        static double compute(const double* y_proba, const int* y_test, size_t nSamples, size_t nClasses);
     private:
-        double compute_common(size_t nSamples, size_t classIdx);
-        std::vector<std::pair<double, int>> scoresAndLabels;
-        std::vector<int> y_test;
+        static double class_auc(const double* y_proba, const int* y_test, size_t nSamples, size_t nClasses, size_t classIdx);
     };
 }
-#endif
\ No newline at end of file
+#endif
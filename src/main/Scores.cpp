@@ -1,6 +1,8 @@
 #include <sstream>
+#include <numeric>
+#include <stdexcept>
 #include "Scores.h"
-#include "common/TensorUtils.hpp" // tensorToVector
+#include "RocAuc.h"
 #include "common/Colors.h"
 namespace platform {
     Scores::Scores(torch::Tensor& y_test, torch::Tensor& y_proba, int num_classes, std::vector<std::string> labels) : num_classes(num_classes), labels(labels), y_test(y_test), y_proba(y_proba)
@@ -9,14 +11,22 @@ namespace platform {
             init_default_labels();
         }
         total = y_test.size(0);
-        auto y_pred = y_proba.argmax(1);
-        accuracy_value = (y_pred == y_test).sum().item<float>() / total;
         init_confusion_matrix();
+        // Single pass over the raw labels, torch is only used to get the predictions
+        auto y_true = y_test.to(torch::kInt32).contiguous();
+        auto y_pred = y_proba.argmax(1).to(torch::kInt32).contiguous();
+        const int* true_ptr = y_true.data_ptr<int>();
+        const int* pred_ptr = y_pred.data_ptr<int>();
         for (int i = 0; i < total; i++) {
-            int actual = y_test[i].item<int>();
-            int predicted = y_pred[i].item<int>();
-            confusion_matrix[actual][predicted] += 1;
+            int actual = true_ptr[i];
+            int predicted = pred_ptr[i];
+            if (actual < 0 || actual >= num_classes || predicted < 0 || predicted >= num_classes) {
+                throw std::out_of_range("Class label out of range in Scores: " + std::to_string(actual) + " / " + std::to_string(predicted));
+            }
+            cell(actual, predicted) += 1;
         }
+        compute_class_counts();
+        accuracy_value = static_cast<float>(std::accumulate(tp.begin(), tp.end(), 0)) / total;
     }
     Scores::Scores(const json& confusion_matrix_)
     {
@@ -35,54 +45,25 @@ namespace platform {
             }
             for (int j = 0; j < num_classes; ++j) {
                 int value_int = values[j].get<int>();
-                confusion_matrix[i][j] = value_int;
+                cell(i, j) = value_int;
                 total += value_int;
             }
             i++;
         }
+        compute_class_counts();
         compute_accuracy_value();
     }
     float Scores::auc()
     {
         size_t nSamples = y_test.numel();
         if (nSamples == 0) return 0;
-        // In binary classification problem there's no need to calculate the average of the AUCs
-        auto nClasses = num_classes;
-        if (num_classes == 2)
-            nClasses = 1;
-        auto y_testv = TensorUtils::tensorToVector<int>(y_test);
-        std::vector<double> aucScores(nClasses, 0.0);
-        std::vector<std::pair<double, int>> scoresAndLabels;
-        for (size_t classIdx = 0; classIdx < nClasses; ++classIdx) {
-            if (classIdx >= y_proba.size(1)) {
-                std::cerr << "AUC warning - class index out of range" << std::endl;
-                return 0;
-            }
-            scoresAndLabels.clear();
-            for (size_t i = 0; i < nSamples; ++i) {
-                scoresAndLabels.emplace_back(y_proba[i][classIdx].item<float>(), y_testv[i] == classIdx ? 1 : 0);
-            }
-            std::sort(scoresAndLabels.begin(), scoresAndLabels.end(), std::greater<>());
-            std::vector<double> tpr, fpr;
-            double tp = 0, fp = 0;
-            double totalPos = std::count(y_testv.begin(), y_testv.end(), classIdx);
-            double totalNeg = nSamples - totalPos;
-            for (const auto& [score, label] : scoresAndLabels) {
-                if (label == 1) {
-                    tp += 1;
-                } else {
-                    fp += 1;
-                }
-                tpr.push_back(tp / totalPos);
-                fpr.push_back(fp / totalNeg);
-            }
-            double auc = 0.0;
-            for (size_t i = 1; i < tpr.size(); ++i) {
-                auc += 0.5 * (fpr[i] - fpr[i - 1]) * (tpr[i] + tpr[i - 1]);
-            }
-            aucScores[classIdx] = auc;
+        if (y_proba.size(1) < num_classes) {
+            std::cerr << "AUC warning - class index out of range" << std::endl;
+            return 0;
         }
-        return std::accumulate(aucScores.begin(), aucScores.end(), 0.0) / nClasses;
+        auto proba = y_proba.narrow(1, 0, num_classes).to(torch::kDouble).contiguous();
+        auto labels = y_test.to(torch::kInt32).contiguous();
+        return RocAuc::compute(proba.data_ptr<double>(), labels.data_ptr<int>(), nSamples, num_classes);
     }
     Scores Scores::create_aggregate(const json& data, const std::string key)
     {
@@ -97,14 +78,35 @@ namespace platform {
     {
         accuracy_value = 0;
         for (int i = 0; i < num_classes; i++) {
-            accuracy_value += confusion_matrix[i][i].item<int>();
+            accuracy_value += tp[i];
         }
         accuracy_value /= total;
         accuracy_value = std::min(accuracy_value, 1.0f);
     }
     void Scores::init_confusion_matrix()
     {
-        confusion_matrix = torch::zeros({ num_classes, num_classes }, torch::kInt32);
+        confusion_matrix.assign(num_classes * num_classes, 0);
+    }
+    void Scores::compute_class_counts()
+    {
+        tp.assign(num_classes, 0);
+        fp.assign(num_classes, 0);
+        fn.assign(num_classes, 0);
+        for (int i = 0; i < num_classes; i++) {
+            for (int j = 0; j < num_classes; j++) {
+                int value = cell(i, j);
+                if (i == j) {
+                    tp[i] += value;
+                } else {
+                    fn[i] += value;
+                    fp[j] += value;
+                }
+            }
+        }
+    }
+    torch::Tensor Scores::get_confusion_matrix()
+    {
+        return torch::from_blob(confusion_matrix.data(), { num_classes, num_classes }, torch::kInt32).clone();
     }
     void Scores::init_default_labels()
     {
@@ -116,8 +118,11 @@ namespace platform {
     {
         if (a.num_classes != num_classes)
             throw std::invalid_argument("The number of classes must be the same");
-        confusion_matrix += a.confusion_matrix;
+        for (size_t i = 0; i < confusion_matrix.size(); i++) {
+            confusion_matrix[i] += a.confusion_matrix[i];
+        }
         total += a.total;
+        compute_class_counts();
         compute_accuracy_value();
     }
     float Scores::accuracy()
@@ -136,7 +141,7 @@ namespace platform {
     {
         float f1_weighted = 0;
         for (int i = 0; i < num_classes; i++) {
-            f1_weighted += confusion_matrix[i].sum().item<int>() * f1_score(i);
+            f1_weighted += (tp[i] + fn[i]) * f1_score(i);
         }
         return f1_weighted / total;
     }
@@ -150,19 +155,13 @@ namespace platform {
     }
     float Scores::precision(int num_class)
     {
-        int tp = confusion_matrix[num_class][num_class].item<int>();
-        int fp = confusion_matrix.index({ "...", num_class }).sum().item<int>() - tp;
-        int fn = confusion_matrix[num_class].sum().item<int>() - tp;
-        if (tp + fp == 0) return 0; // Avoid division by zero (0/0 = 0
-        return float(tp) / (tp + fp);
+        if (tp[num_class] + fp[num_class] == 0) return 0; // Avoid division by zero (0/0 = 0
+        return float(tp[num_class]) / (tp[num_class] + fp[num_class]);
     }
     float Scores::recall(int num_class)
     {
-        int tp = confusion_matrix[num_class][num_class].item<int>();
-        int fp = confusion_matrix.index({ "...", num_class }).sum().item<int>() - tp;
-        int fn = confusion_matrix[num_class].sum().item<int>() - tp;
-        if (tp + fn == 0) return 0; // Avoid division by zero (0/0 = 0
-        return float(tp) / (tp + fn);
+        if (tp[num_class] + fn[num_class] == 0) return 0; // Avoid division by zero (0/0 = 0
+        return float(tp[num_class]) / (tp[num_class] + fn[num_class]);
     }
     std::string Scores::classification_report_line(std::string label, float precision, float recall, float f1_score, int support)
     {
@@ -189,7 +188,7 @@ namespace platform {
         float precision_wavg = 0;
         float recall_wavg = 0;
         for (int i = 0; i < num_classes; i++) {
-            int support = confusion_matrix[i].sum().item<int>();
+            int support = tp[i] + fn[i];
             precision_avg += precision(i);
             precision_wavg += precision(i) * support;
             recall_avg += recall(i);
@@ -215,7 +214,7 @@ namespace platform {
         oss << std::string(label_len, ' ') << " ========= ========= ========= =========";
         report.push_back(oss.str()); oss.str("");
         for (int i = 0; i < num_classes; i++) {
-            report.push_back(classification_report_line(labels[i], precision(i), recall(i), f1_score(i), confusion_matrix[i].sum().item<int>()));
+            report.push_back(classification_report_line(labels[i], precision(i), recall(i), f1_score(i), tp[i] + fn[i]));
         }
         report.push_back(" ");
         oss << classification_report_line("accuracy", 0, 0, accuracy(), total);
@@ -231,7 +230,7 @@ namespace platform {
             oss << std::right << std::setw(label_len) << labels[i] << " ";
             for (int j = 0; j < num_classes; j++) {
                 if (i == j) oss << Colors::GREEN();
-                oss << std::setw(number) << confusion_matrix[i][j].item<int>() << " ";
+                oss << std::setw(number) << cell(i, j) << " ";
                 if (i == j) oss << color;
             }
             report.push_back(oss.str()); oss.str("");
@@ -245,7 +244,7 @@ namespace platform {
         output["headers"] = { " ", "precision", "recall", "f1-score", "support" };
         output["body"] = {};
         for (int i = 0; i < num_classes; i++) {
-            output["body"].push_back({ labels[i], precision(i), recall(i), f1_score(i), confusion_matrix[i].sum().item<int>() });
+            output["body"].push_back({ labels[i], precision(i), recall(i), f1_score(i), tp[i] + fn[i] });
         }
         output["accuracy"] = { "accuracy", 0, 0, accuracy(), total };
         auto [precision_avg, recall_avg, precision_wavg, recall_wavg] = compute_averages();
@@ -258,7 +257,7 @@ namespace platform {
     {
         json output;
         for (int i = 0; i < num_classes; i++) {
-            auto r_ptr = confusion_matrix[i].data_ptr<int>();
+            auto r_ptr = confusion_matrix.data() + i * num_classes;
             if (labels_as_keys) {
                 output[labels[i]] = std::vector<int>(r_ptr, r_ptr + num_classes);
             } else {
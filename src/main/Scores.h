@@ -19,7 +19,7 @@ namespace platform {
         float f1_macro();
         float precision(int num_class);
         float recall(int num_class);
-        torch::Tensor get_confusion_matrix() { return confusion_matrix; }
+        torch::Tensor get_confusion_matrix();
         std::vector<std::string> classification_report(std::string color = "", std::string title = "");
         json classification_report_json(std::string title = "");
         json get_confusion_matrix_json(bool labels_as_keys = false);
@@ -27,6 +27,8 @@ namespace platform {
     private:
         std::string classification_report_line(std::string label, float precision, float recall, float f1_score, int support);
         void init_confusion_matrix();
+        void compute_class_counts();
+        int& cell(int actual, int predicted) { return confusion_matrix[actual * num_classes + predicted]; }
         void init_default_labels();
         void compute_accuracy_value();
         std::tuple<float, float, float, float> compute_averages();
@@ -34,7 +36,8 @@ namespace platform {
         float accuracy_value;
         int total;
         std::vector<std::string> labels;
-        torch::Tensor confusion_matrix; // Rows ar actual, columns are predicted
+        std::vector<int> confusion_matrix; // num_classes x num_classes row major, rows are actual, columns are predicted
+        std::vector<int> tp, fp, fn; // per class counts, computed once from the confusion matrix
         torch::Tensor null_t; // Covenient null tensor needed when confusion_matrix constructor is used
         torch::Tensor& y_test = null_t; // for ROC AUC
         torch::Tensor& y_proba = null_t; // for ROC AUC
@@ -329,6 +329,8 @@ namespace platform {
             list("Model already set to " + newModel, Colors::RED());
             return;
         }
+        // Read the whole result before its file is removed, the list only holds its summary
+        results.at(index).loadFull();
         // Remove the old result file
         std::string oldFile = path + results.at(index).getFilename();
         std::filesystem::remove(oldFile);
@@ -352,6 +354,8 @@ namespace platform {
             list("Result not moved", Colors::YELLOW());
             return;
         }
+        // Read the whole result before its file is removed, the list only holds its summary
+        results.at(index).loadFull();
         // Remove the old result file
         std::string oldFile = path + results.at(index).getFilename();
         std::filesystem::remove(oldFile);
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include "results/ResultsCatalog.h"
 #include "ResultsManager.h"
 
 namespace platform {
@@ -8,23 +9,18 @@ namespace platform {
     }
     void ResultsManager::load()
     {
-        using std::filesystem::directory_iterator;
         bool found = false;
-        for (const auto& file : directory_iterator(path)) {
-            auto filename = file.path().filename().string();
-            if (filename.find(".json") != std::string::npos && filename.find("results_") == 0) {
-                auto result = Result(path, filename);
-                bool addResult = true;
-                if (platform != "any" && result.getPlatform() != platform
-                    || model != "any" && result.getModel() != model
-                    || scoreName != "any" && scoreName != result.getScoreName()
-                    || complete && !result.isComplete()
-                    || partial && result.isComplete())
-                    addResult = false;
-                if (addResult) {
-                    files.push_back(result);
-                    found = true;
-                }
+        for (auto& result : ResultsCatalog(path).load()) {
+            bool addResult = true;
+            if (platform != "any" && result.getPlatform() != platform
+                || model != "any" && result.getModel() != model
+                || scoreName != "any" && scoreName != result.getScoreName()
+                || complete && !result.isComplete()
+                || partial && result.isComplete())
+                addResult = false;
+            if (addResult) {
+                files.push_back(std::move(result));
+                found = true;
             }
         }
         if (found) {
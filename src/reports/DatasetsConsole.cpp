@@ -23,7 +23,7 @@ namespace platform {
     {
         header.clear();
         body.clear();
-        auto datasets = platform::Datasets(false, platform::Paths::datasets());
+        auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
         std::stringstream sheader;
         auto datasets_names = datasets.getNames();
         std::cout << Colors::GREEN() << "Datasets available in the platform: " << datasets_names.size() << std::endl;
@@ -49,23 +49,21 @@ namespace platform {
             auto color = num % 2 ? Colors::CYAN() : Colors::BLUE();
             line << color << setw(3) << right << num++ << " ";
             line << setw(maxName) << left << dataset_name << " ";
-            auto& dataset = datasets.getDataset(dataset_name);
-            dataset.load();
-            auto nSamples = dataset.getNSamples();
+            auto stats = datasets.getStats(dataset_name);
+            auto nSamples = stats.samples;
             line << setw(header_lengths[2]) << right << nSamples << " ";
-            auto nFeatures = dataset.getFeatures().size();
+            auto nFeatures = stats.features;
             line << setw(header_lengths[3]) << right << nFeatures << " ";
-            auto numericFeatures = dataset.getNumericFeatures();
-            auto num = std::count(numericFeatures.begin(), numericFeatures.end(), true);
+            auto num = stats.numeric;
             line << setw(header_lengths[4]) << right << num << " ";
-            auto nClasses = dataset.getNClasses();
+            auto nClasses = stats.classes;
             line << setw(header_lengths[5]) << right << nClasses << " ";
             std::string sep = "";
             oss.str("");
             if (nSamples == 0) {
                 oss << "No samples";
             } else {
-                for (auto number : dataset.getClassesCounts()) {
+                for (auto number : stats.classes_counts) {
                     oss << sep << std::setprecision(2) << fixed << (float)number / nSamples * 100.0 << "% (" << number << ")";
                     sep = " / ";
                 }
@@ -60,13 +60,11 @@ namespace platform {
             }
         } else {
             if (data["score_name"].get<std::string>() == "accuracy") {
-                auto datasets = Datasets(false, Paths::datasets());
-                auto& dt = datasets.getDataset(dataset);
-                dt.load();
-                auto numClasses = dt.getNClasses();
-                if (numClasses == 2) {
-                    std::vector<int> distribution = dt.getClassesCounts();
-                    double nSamples = dt.getNSamples();
+                auto& datasets = Datasets::shared(false, Paths::datasets());
+                auto stats = datasets.getStats(dataset);
+                if (stats.classes == 2) {
+                    std::vector<int> distribution = stats.classes_counts;
+                    double nSamples = stats.samples;
                     std::vector<int>::iterator maxValue = max_element(distribution.begin(), distribution.end());
                     double mark = *maxValue / nSamples * (1 + margin);
                     if (mark > 1) {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <regex>
 #include <nlohmann/json.hpp>
+#include "ResultFile.hpp"
 
 namespace platform {
     using json = nlohmann::ordered_json;
@@ -25,14 +26,7 @@ namespace platform {
         }
         json load_json_file(const std::string& fileName)
         {
-            std::ifstream file(fileName);
-            if (!file.is_open()) {
-                throw std::runtime_error("Error: Unable to open file " + fileName);
-            }
-            json data;
-            file >> data;
-            file.close();
-            return data;
+            return ResultFile::read(fileName);
         }
         void fix_it(const std::string& fileName)
         {
@@ -58,13 +52,12 @@ namespace platform {
                 }
             }
             // Save fixed JSON
-            std::ofstream outFile(fileName);
-            if (!outFile.is_open()) {
+            try {
+                ResultFile::write(fileName, data, 4);
+            }
+            catch (const std::runtime_error&) {
                 std::cerr << "Error: Unable to open file for writing." << std::endl;
-                return;
             }
-            outFile << data.dump(4);
-            outFile.close();
         }
 
     private:
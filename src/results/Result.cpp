@@ -11,6 +11,7 @@
 #include "common/Symbols.h"
 #include "Result.h"
 #include "JsonValidator.h"
+#include "ResultFile.hpp"
 #include "SchemaV1_0.h"
 
 namespace platform {
@@ -55,12 +56,16 @@ namespace platform {
     {
         this->path = path;
         this->fileName = fileName;
-        std::ifstream resultData(path + "/" + fileName);
-        if (resultData.is_open()) {
-            data = json::parse(resultData);
-        } else {
-            throw std::invalid_argument("Unable to open result file. [" + path + "/" + fileName + "]");
-        }
+        data = ResultFile::read(path + "/" + fileName);
+        computeScore();
+    }
+    Result::Result(const std::string& path, const std::string& fileName, const json& summary, const std::vector<std::string>& errors)
+        : path(path), fileName(fileName), data(summary), summary(true), errors(errors)
+    {
+        computeScore();
+    }
+    void Result::computeScore()
+    {
         score = 0;
         for (const auto& result : data["results"]) {
             score += result["score"].get<double>();
@@ -72,24 +77,53 @@ namespace platform {
         }
         complete = data["results"].size() > 1;
     }
+    json Result::getSummary() const
+    {
+        json output = json::object();
+        for (const auto& [key, value] : data.items()) {
+            if (key != "results") {
+                output[key] = value;
+            }
+        }
+        output["results"] = json::array();
+        for (const auto& item : data.at("results")) {
+            json entry = json::object();
+            for (const auto& key : { "dataset", "score", "score_std", "hyperparameters" }) {
+                if (item.contains(key)) {
+                    entry[key] = item[key];
+                }
+            }
+            output["results"].push_back(entry);
+        }
+        return output;
+    }
+    void Result::loadFull()
+    {
+        if (summary) {
+            *this = Result(path, fileName);
+        }
+    }
     json Result::getJson()
     {
+        loadFull();
         return data;
     }
     std::vector<std::string> Result::check()
     {
+        if (summary) {
+            return errors;
+        }
         platform::JsonValidator validator(platform::SchemaV1_0::schema);
         return validator.validate(data);
     }
     void Result::save(const std::string& path)
     {
+        loadFull();
         do {
             fileName = generateFileName();
         }
         while (std::filesystem::exists(path + fileName));
-        std::ofstream file(path + fileName);
-        file << data;
-        file.close();
+        ResultFile::write(path + fileName, data);
     }
     std::string Result::generateFileName()
     {
@@ -125,7 +159,7 @@ namespace platform {
             << data["date"].get<std::string>() << "_"
             << data["time"].get<std::string>() << "_"
             << stratified << "_"
-            << generateRandomString(5) << ".json";
+            << generateRandomString(5) << ResultFile::extension();
         return oss.str();
     }
     std::string Result::to_string(int maxModel, int maxTitle) const
@@ -16,6 +16,10 @@ namespace platform {
     public:
         Result();
         Result(const std::string& path, const std::string& filename);
+        // Result built from a catalog summary, the full file is read only when getJson() is called
+        Result(const std::string& path, const std::string& filename, const json& summary, const std::vector<std::string>& errors);
+        // Header fields and, for each dataset, its score, score_std and hyperparameters
+        json getSummary() const;
         void save(const std::string& path);
         std::vector<std::string> check();
         // Getters
@@ -30,32 +34,40 @@ namespace platform {
         std::string getModel() const { return data["model"].get<std::string>(); };
         std::string getPlatform() const { return data["platform"].get<std::string>(); };
         std::string getScoreName() const { return data["score_name"].get<std::string>(); };
-        void setSchemaVersion(const std::string& version) { data["schema_version"] = version; };
+        void setSchemaVersion(const std::string& version) { loadFull(); data["schema_version"] = version; };
         bool isComplete() const { return complete; };
+        // With a summary result "results" only holds the fields kept by getSummary()
         json getData() const { return data; }
+        bool isSummary() const { return summary; };
+        // Replaces a summary result by its full file, so it can be changed or saved without losing data.
+        // The setters and save() call it, it has to be called before the file is moved or removed
+        void loadFull();
         // Setters
-        void setTitle(const std::string& title) { data["title"] = title; };
-        void setSmoothStrategy(const std::string& smooth_strategy) { data["smooth_strategy"] = smooth_strategy; };
-        void setDiscretizationAlgorithm(const std::string& discretization_algo) { data["discretization_algorithm"] = discretization_algo; };
-        void setLanguage(const std::string& language) { data["language"] = language; };
-        void setLanguageVersion(const std::string& language_version) { data["language_version"] = language_version; };
-        void setDuration(double duration) { data["duration"] = duration; };
-        void setModel(const std::string& model) { data["model"] = model; };
-        void setModelVersion(const std::string& model_version) { data["version"] = model_version; };
-        void setScoreName(const std::string& scoreName) { data["score_name"] = scoreName; };
-        void setDiscretized(bool discretized) { data["discretized"] = discretized; };
-        void addSeed(int seed) { data["seeds"].push_back(seed); };
-        void addPartial(PartialResult& partial_result) { data["results"].push_back(partial_result.getJson()); };
-        void setStratified(bool stratified) { data["stratified"] = stratified; };
-        void setNFolds(int nfolds) { data["folds"] = nfolds; };
-        void setPlatform(const std::string& platform_name) { data["platform"] = platform_name; };
+        void setTitle(const std::string& title) { loadFull(); data["title"] = title; };
+        void setSmoothStrategy(const std::string& smooth_strategy) { loadFull(); data["smooth_strategy"] = smooth_strategy; };
+        void setDiscretizationAlgorithm(const std::string& discretization_algo) { loadFull(); data["discretization_algorithm"] = discretization_algo; };
+        void setLanguage(const std::string& language) { loadFull(); data["language"] = language; };
+        void setLanguageVersion(const std::string& language_version) { loadFull(); data["language_version"] = language_version; };
+        void setDuration(double duration) { loadFull(); data["duration"] = duration; };
+        void setModel(const std::string& model) { loadFull(); data["model"] = model; };
+        void setModelVersion(const std::string& model_version) { loadFull(); data["version"] = model_version; };
+        void setScoreName(const std::string& scoreName) { loadFull(); data["score_name"] = scoreName; };
+        void setDiscretized(bool discretized) { loadFull(); data["discretized"] = discretized; };
+        void addSeed(int seed) { loadFull(); data["seeds"].push_back(seed); };
+        void addPartial(PartialResult& partial_result) { loadFull(); data["results"].push_back(partial_result.getJson()); };
+        void setStratified(bool stratified) { loadFull(); data["stratified"] = stratified; };
+        void setNFolds(int nfolds) { loadFull(); data["folds"] = nfolds; };
+        void setPlatform(const std::string& platform_name) { loadFull(); data["platform"] = platform_name; };
     private:
         std::string generateFileName();
+        void computeScore();
         std::string path;
         std::string fileName;
         json data;
         bool complete;
         double score = 0.0;
+        bool summary = false;
+        std::vector<std::string> errors; // schema errors of a summary result
     };
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef RESULTFILE_HPP
+#define RESULTFILE_HPP
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "common/DotEnv.h"
+
+namespace platform {
+    using json = nlohmann::ordered_json;
+    //
+    // Result files are stored as JSON text (.json) or CBOR (.cbor). Both hold the same document,
+    // the encoding of the new files is selected with the result_format key of .env (json by default)
+    //
+    class ResultFile {
+    public:
+        static bool isResultFile(const std::string& fileName)
+        {
+            auto name = std::filesystem::path(fileName).filename().string();
+            return name.starts_with("results_") && (name.ends_with(".json") || name.ends_with(".cbor"));
+        }
+        static bool isBinary(const std::string& fileName)
+        {
+            return fileName.ends_with(".cbor");
+        }
+        static std::string extension(const std::string& format)
+        {
+            if (format != "json" && format != "cbor") {
+                throw std::invalid_argument("Unknown result format: " + format);
+            }
+            return "." + format;
+        }
+        // Extension of the new result files
+        static std::string extension()
+        {
+            auto format = DotEnv().get("result_format");
+            return extension(format.empty() ? "json" : format);
+        }
+        static json read(const std::string& fileName)
+        {
+            std::ifstream file(fileName, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::invalid_argument("Unable to open result file. [" + fileName + "]");
+            }
+            if (isBinary(fileName)) {
+                std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                return json::from_cbor(buffer);
+            }
+            return json::parse(file);
+        }
+        // indent is only used with JSON text, -1 gives the compact form
+        static void write(const std::string& fileName, const json& data, int indent = -1)
+        {
+            std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Unable to write result file. [" + fileName + "]");
+            }
+            if (isBinary(fileName)) {
+                auto buffer = json::to_cbor(data);
+                file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            } else {
+                file << data.dump(indent);
+            }
+        }
+        // Rewrites fileName in format (json or cbor) and removes the original, returns the new file name
+        static std::string convert(const std::string& fileName, const std::string& format)
+        {
+            auto target = std::filesystem::path(fileName).replace_extension(extension(format)).string();
+            if (target == fileName) {
+                return fileName;
+            }
+            if (std::filesystem::exists(target)) {
+                throw std::runtime_error("Result file already exists. [" + target + "]");
+            }
+            write(target, read(fileName));
+            std::filesystem::remove(fileName);
+            return target;
+        }
+    };
+}
+#endif
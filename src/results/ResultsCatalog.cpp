@@ -0,0 +1,129 @@
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unistd.h>
+#include "ResultFile.hpp"
+#include "ResultsCatalog.h"
+
+namespace platform {
+    const std::string catalog_name = ".catalog.cbor";
+    const int catalog_version = 1;
+
+    ResultsCatalog::ResultsCatalog(const std::string& path) : path(path)
+    {
+        catalogFile = (std::filesystem::path(path) / catalog_name).string();
+    }
+    json ResultsCatalog::readCatalog() const
+    {
+        std::ifstream file(catalogFile, std::ios::binary);
+        if (!file.is_open()) {
+            return json::object();
+        }
+        std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        // A damaged or outdated catalog is rebuilt from the result files
+        auto catalog = json::from_cbor(buffer, true, false);
+        if (catalog.is_discarded() || !catalog.is_object() || catalog.value("version", 0) != catalog_version || !catalog.contains("files")) {
+            return json::object();
+        }
+        return catalog["files"];
+    }
+    void ResultsCatalog::writeCatalog(const json& files) const
+    {
+        json catalog = { { "version", catalog_version }, { "files", files } };
+        auto tmpName = catalogFile + "." + std::to_string(::getpid()) + ".tmp";
+        {
+            std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return; // read only folder, the catalog is just not saved
+            }
+            auto buffer = json::to_cbor(catalog);
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpName, catalogFile, ec);
+        if (ec) {
+            std::filesystem::remove(tmpName, ec);
+        }
+    }
+    std::vector<Result> ResultsCatalog::load()
+    {
+        using std::filesystem::directory_iterator;
+        auto previous = readCatalog();
+        json files = json::object();
+        // Slots in directory order, the ones of new or modified files are filled by the parsers
+        std::vector<std::optional<Result>> slots;
+        struct Pending {
+            size_t slot;
+            std::string filename;
+            std::int64_t size, mtime;
+            json entry;
+        };
+        std::vector<Pending> pending;
+        for (const auto& file : directory_iterator(path)) {
+            auto filename = file.path().filename().string();
+            if (!ResultFile::isResultFile(filename)) {
+                continue;
+            }
+            auto size = static_cast<std::int64_t>(file.file_size());
+            auto mtime = static_cast<std::int64_t>(file.last_write_time().time_since_epoch().count());
+            auto it = previous.find(filename);
+            if (it != previous.end() && it->value("size", std::int64_t(-1)) == size && it->value("mtime", std::int64_t(-1)) == mtime) {
+                slots.emplace_back(std::in_place, path, filename, it->at("summary"), it->at("errors").get<std::vector<std::string>>());
+                files[filename] = std::move(*it);
+                continue;
+            }
+            pending.push_back({ slots.size(), filename, size, mtime, json() });
+            slots.emplace_back();
+        }
+        // New or modified files are parsed concurrently
+        std::atomic<size_t> next{ 0 };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto parser = [&]() {
+            for (size_t i = next++; i < pending.size(); i = next++) {
+                try {
+                    auto& task = pending[i];
+                    auto result = Result(path, task.filename);
+                    auto errors = result.check();
+                    auto summary = result.getSummary();
+                    slots[task.slot].emplace(path, task.filename, summary, errors);
+                    task.entry = { { "size", task.size }, { "mtime", task.mtime }, { "errors", errors }, { "summary", std::move(summary) } };
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+            };
+        size_t n_threads = std::min<size_t>(pending.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < n_threads; ++t) {
+            workers.emplace_back(parser);
+        }
+        parser();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        for (auto& task : pending) {
+            files[task.filename] = std::move(task.entry);
+        }
+        if (!pending.empty() || files.size() != previous.size()) {
+            writeCatalog(files);
+        }
+        std::vector<Result> results;
+        results.reserve(slots.size());
+        for (auto& slot : slots) {
+            results.push_back(std::move(*slot));
+        }
+        return results;
+    }
+}
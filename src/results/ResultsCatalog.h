@@ -0,0 +1,27 @@
+#ifndef RESULTSCATALOG_H
+#define RESULTSCATALOG_H
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "results/Result.h"
+namespace platform {
+    using json = nlohmann::ordered_json;
+    //
+    // Summaries of the result files of a folder kept in a catalog file in the same folder.
+    // Every entry is keyed by file name and stores the size and modification time of the file,
+    // its header fields, the score, score_std and hyperparameters of each dataset and the schema
+    // errors. Only the files that are new or have changed since the catalog was written are parsed.
+    //
+    class ResultsCatalog {
+    public:
+        explicit ResultsCatalog(const std::string& path);
+        // Results of the result files (results_*.json or results_*.cbor) of the folder, in directory order
+        std::vector<Result> load();
+    private:
+        json readCatalog() const;
+        void writeCatalog(const json& catalog) const;
+        std::string path;
+        std::string catalogFile;
+    };
+}
+#endif
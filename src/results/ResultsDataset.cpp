@@ -1,5 +1,6 @@
 #include <algorithm>
 #include "common/Paths.h"
+#include "ResultsCatalog.h"
 #include "ResultsDataset.h"
 
 namespace platform {
@@ -9,24 +10,19 @@ namespace platform {
     }
     void ResultsDataset::load()
     {
-        using std::filesystem::directory_iterator;
-        for (const auto& file : directory_iterator(path)) {
-            auto filename = file.path().filename().string();
-            if (filename.find(".json") != std::string::npos && filename.find("results_") == 0) {
-                auto result = Result(path, filename);
-                if (model != "any" && result.getModel() != model)
-                    continue;
-                auto data = result.getData()["results"];
-                for (auto const& item : data) {
-                    if (item["dataset"] == dataset) {
-                        auto hyper_length = item["hyperparameters"].dump().size();
-                        if (hyper_length > maxHyper)
-                            maxHyper = hyper_length;
-                        if (item["score"].get<double>() > maxResult)
-                            maxResult = item["score"].get<double>();
-                        files.push_back(result);
-                        break;
-                    }
+        for (auto& result : ResultsCatalog(path).load()) {
+            if (model != "any" && result.getModel() != model)
+                continue;
+            auto data = result.getData()["results"];
+            for (auto const& item : data) {
+                if (item["dataset"] == dataset) {
+                    auto hyper_length = item["hyperparameters"].dump().size();
+                    if (hyper_length > maxHyper)
+                        maxHyper = hyper_length;
+                    if (item["score"].get<double>() > maxResult)
+                        maxResult = item["score"].get<double>();
+                    files.push_back(std::move(result));
+                    break;
                 }
             }
         }
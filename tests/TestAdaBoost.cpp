@@ -8,6 +8,7 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <torch/torch.h>
 #include <memory>
 #include <stdexcept>
@@ -239,6 +240,28 @@ TEST_CASE("AdaBoost Tensor Interface", "[AdaBoost]")
             REQUIRE(prob_sums[i].item<double>() == Catch::Approx(1.0).epsilon(1e-6));
         }
     }
+    SECTION("Batched inference matches single sample predictions")
+    {
+        // Stumps use the compiled tables and deeper trees the flat tree traversal
+        auto depth = GENERATE(1, 3);
+        AdaBoost ada(20, depth);
+        ada.fit(raw.dataset, raw.featurest, raw.classNamet, raw.statest, Smoothing_t::NONE);
+        auto predictions = ada.predict(raw.Xt);
+        auto proba = ada.predict_proba(raw.Xt);
+        int n_features = raw.Xt.size(0);
+        for (int i = 0; i < raw.nSamples; i++) {
+            // The same sample predicted alone, as a one column matrix
+            std::vector<std::vector<int>> sample(n_features, std::vector<int>(1));
+            for (int f = 0; f < n_features; f++) {
+                sample[f][0] = raw.Xt[f][i].item<int>();
+            }
+            REQUIRE(predictions[i].item<int>() == ada.predict(sample)[0]);
+            auto sample_proba = ada.predict_proba(sample)[0];
+            for (int j = 0; j < proba.size(1); j++) {
+                REQUIRE(proba[i][j].item<float>() == static_cast<float>(sample_proba[j]));
+            }
+        }
+    }
 }
 
 TEST_CASE("AdaBoost SAMME Algorithm Validation", "[AdaBoost]")
@@ -350,6 +373,54 @@ TEST_CASE("AdaBoost SAMME Algorithm Validation", "[AdaBoost]")
     }
 }
 
+TEST_CASE("AdaBoost alphas match the tensor reference", "[AdaBoost]")
+{
+    // SAMME computed with double tensors as fit receives the weights; the fused weight update has to
+    // give the same estimator weights up to the summation order of the reductions
+    auto raw = RawDatasets("iris", true);
+    auto depth = GENERATE(1, 3);
+    const int n_estimators = 10;
+    int n_classes = raw.statest[raw.classNamet].size();
+    double random_guess_error = 1.0 - 1.0 / n_classes;
+    auto normalize = [](torch::Tensor& weights) {
+        weights /= weights.sum().item<double>();
+        weights = torch::clamp_min(weights, 1e-15);
+        weights /= weights.sum().item<double>();
+        };
+    auto weights = torch::full({ raw.nSamples }, 1.0 / raw.nSamples, torch::kDouble);
+    normalize(weights);
+    std::vector<double> expected;
+    for (int iter = 0; iter < n_estimators; ++iter) {
+        DecisionTree tree(depth);
+        torch::Tensor tree_weights = weights / weights.sum();
+        tree.fit(raw.dataset, raw.featurest, raw.classNamet, raw.statest, tree_weights, Smoothing_t::NONE);
+        auto incorrect = (tree.predict(raw.Xt) != raw.yt).to(torch::kDouble);
+        double error = std::clamp(torch::dot(incorrect, weights).item<double>(), 1e-15, 1.0 - 1e-15);
+        if (error >= random_guess_error) {
+            if (expected.empty())
+                expected.push_back(0.0);
+            break;
+        }
+        if (error <= 1e-10) {
+            expected.push_back(10.0 + std::log(n_classes - 1.0));
+            break;
+        }
+        double alpha = std::log((1.0 - error) / error) + std::log(n_classes - 1.0);
+        expected.push_back(std::clamp(alpha, -10.0, 10.0));
+        if (iter < n_estimators - 1) {
+            weights = torch::clamp(weights * torch::exp(expected.back() * incorrect), 1e-15, 1e15);
+            normalize(weights);
+        }
+    }
+    AdaBoost ada(n_estimators, depth);
+    ada.fit(raw.dataset, raw.featurest, raw.classNamet, raw.statest, Smoothing_t::NONE);
+    auto alphas = ada.getEstimatorWeights();
+    REQUIRE(alphas.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(alphas[i] == Catch::Approx(expected[i]).epsilon(1e-9));
+    }
+}
+
 TEST_CASE("AdaBoost Debug - Simple Dataset Analysis", "[AdaBoost][debug]")
 {
     // Create the exact same simple dataset that was failing
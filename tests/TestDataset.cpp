@@ -0,0 +1,254 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <torch/torch.h>
+#include "common/Dataset.h"
+#include "common/Datasets.h"
+#include "common/DotEnv.h"
+#include "common/Paths.h"
+#include "config_platform.h"
+
+namespace {
+    //
+    // Copy of a test dataset in a temporary folder, so its source file can be changed and its cache files
+    // are written there
+    //
+    class DatasetFolder {
+    public:
+        explicit DatasetFolder(const std::string& name, const std::string& className) : name(name), className(className)
+        {
+            folder = std::filesystem::temp_directory_path() / ("platform_test_dataset_" + std::to_string(::getpid()));
+            std::filesystem::remove_all(folder);
+            std::filesystem::create_directories(folder);
+            std::filesystem::copy_file(std::string(platform_data_path) + name + ".arff", source());
+        }
+        ~DatasetFolder()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(folder, ec);
+        }
+        std::string source() const { return (folder / (name + ".arff")).string(); }
+        std::string file(const std::string& extension) const { return source() + extension; }
+        platform::Dataset dataset(bool discretize = false) const
+        {
+            return platform::Dataset(folder.string(), name, className, discretize, platform::ARFF, { -1 }, discretize ? "mdlp" : "none");
+        }
+        std::string read(const std::string& fileName) const
+        {
+            std::ifstream file(fileName, std::ios::binary);
+            std::stringstream content;
+            content << file.rdbuf();
+            return content.str();
+        }
+        // Writes the source keeping its modification time, or making it newer
+        void write(const std::string& content, bool newer)
+        {
+            auto mtime = std::filesystem::last_write_time(source());
+            {
+                std::ofstream file(source(), std::ios::binary | std::ios::trunc);
+                file << content;
+            }
+            std::filesystem::last_write_time(source(), newer ? mtime + std::chrono::seconds(2) : mtime);
+        }
+    private:
+        std::filesystem::path folder;
+        std::string name;
+        std::string className;
+    };
+    void require_same_fold(platform::Dataset& expected, platform::Dataset& computed)
+    {
+        std::vector<int> train(120), test(30);
+        std::iota(train.begin(), train.end(), 0);
+        std::iota(test.begin(), test.end(), 120);
+        auto fold_expected = expected.getFoldTensors(train, test);
+        auto fold_computed = computed.getFoldTensors(train, test);
+        REQUIRE(torch::equal(fold_computed.X_train, fold_expected.X_train));
+        REQUIRE(torch::equal(fold_computed.X_test, fold_expected.X_test));
+        REQUIRE(torch::equal(fold_computed.y_train, fold_expected.y_train));
+        REQUIRE(torch::equal(fold_computed.y_test, fold_expected.y_test));
+        REQUIRE(fold_computed.states == fold_expected.states);
+    }
+}
+
+TEST_CASE("Dataset binary cache", "[Dataset]")
+{
+    DatasetFolder folder("iris", "class");
+    platform::Dataset::setDiscretizationCache(false);
+    // Parsed from the text
+    platform::Dataset::setCacheFolder("none");
+    auto parsed = folder.dataset(true);
+    parsed.load();
+    REQUIRE_FALSE(std::filesystem::exists(folder.file(".platform.bin")));
+    platform::Dataset::setCacheFolder("");
+    auto first = folder.dataset(true);
+    first.load();
+    REQUIRE(std::filesystem::exists(folder.file(".platform.bin")));
+    SECTION("Round trip")
+    {
+        // Same size and modification time with the values scrambled: only the cache has the right data
+        auto content = folder.read(folder.source());
+        auto data = content.find("@DATA");
+        std::replace_if(content.begin() + data, content.end(), [](char c) { return c >= '1' && c <= '9'; }, '0');
+        folder.write(content, false);
+        auto cached = folder.dataset(true);
+        cached.load();
+        REQUIRE(torch::equal(cached.getTensors().first, parsed.getTensors().first));
+        REQUIRE(torch::equal(cached.getTensors().second, parsed.getTensors().second));
+        REQUIRE(cached.getFeatures() == parsed.getFeatures());
+        REQUIRE(cached.getClassName() == parsed.getClassName());
+        REQUIRE(cached.getLabels() == parsed.getLabels());
+        REQUIRE(cached.getNumericFeatures() == parsed.getNumericFeatures());
+        REQUIRE(cached.getNSamples() == 150);
+        REQUIRE(cached.getNFeatures() == 4);
+        require_same_fold(parsed, cached);
+    }
+    SECTION("Rebuilt when the source is newer")
+    {
+        auto cache = folder.read(folder.file(".platform.bin"));
+        // Same size, only the modification time tells the source has changed
+        auto content = folder.read(folder.source());
+        auto data = content.find("5.1,3.5,1.4,0.2", content.find("@DATA"));
+        content.replace(data, 3, "9.1");
+        folder.write(content, true);
+        auto changed = folder.dataset(true);
+        changed.load();
+        REQUIRE(changed.getTensors().first[0][0].item<float>() == Catch::Approx(9.1));
+        REQUIRE(folder.read(folder.file(".platform.bin")) != cache);
+        auto cached = folder.dataset(true);
+        cached.load();
+        REQUIRE(torch::equal(cached.getTensors().first, changed.getTensors().first));
+    }
+    platform::Dataset::setDiscretizationCache(true);
+}
+TEST_CASE("Dataset statistics file", "[Dataset]")
+{
+    DatasetFolder folder("iris", "class");
+    platform::Dataset::setCacheFolder("");
+    auto first = folder.dataset();
+    auto stats = first.getStats();
+    REQUIRE(first.isLoaded());
+    REQUIRE(std::filesystem::exists(folder.file(".platform.stats.json")));
+    REQUIRE(stats.samples == 150);
+    REQUIRE(stats.features == 4);
+    REQUIRE(stats.numeric == 4);
+    REQUIRE(stats.classes == 3);
+    REQUIRE(stats.classes_counts == std::vector<int>{ 50, 50, 50 });
+    REQUIRE(stats.labels == first.getLabels());
+    SECTION("Read without loading the dataset")
+    {
+        auto second = folder.dataset();
+        auto stored = second.getStats();
+        REQUIRE_FALSE(second.isLoaded());
+        REQUIRE(stored.samples == stats.samples);
+        REQUIRE(stored.features == stats.features);
+        REQUIRE(stored.numeric == stats.numeric);
+        REQUIRE(stored.classes == stats.classes);
+        REQUIRE(stored.classes_counts == stats.classes_counts);
+        REQUIRE(stored.labels == stats.labels);
+    }
+    SECTION("Computed again when the source changes")
+    {
+        folder.write(folder.read(folder.source()) + "5.0,3.0,1.0,0.2,Iris-setosa\n", true);
+        auto second = folder.dataset();
+        auto changed = second.getStats();
+        REQUIRE(second.isLoaded());
+        REQUIRE(changed.samples == 151);
+        REQUIRE(changed.classes_counts == std::vector<int>{ 51, 50, 50 });
+        // and the file is rewritten
+        auto third = folder.dataset();
+        REQUIRE(third.getStats().samples == 151);
+        REQUIRE_FALSE(third.isLoaded());
+    }
+}
+TEST_CASE("Datasets memory budget", "[Dataset]")
+{
+    auto dotEnv = platform::DotEnv(true);
+    auto& datasets = platform::Datasets::shared(false, platform::Paths::datasets());
+    auto& iris = datasets.getDataset("iris");
+    auto& glass = datasets.getDataset("glass");
+    auto& ecoli = datasets.getDataset("ecoli");
+    // Every dataset is over the budget, so only the one just used stays loaded
+    platform::Dataset::setMemoryBudget(1);
+    iris.load();
+    glass.load();
+    REQUIRE_FALSE(iris.isLoaded());
+    REQUIRE(glass.isLoaded());
+    SECTION("Unloaded datasets are read again")
+    {
+        iris.load();
+        REQUIRE(iris.isLoaded());
+        REQUIRE(iris.getNSamples() == 150);
+        REQUIRE_FALSE(glass.isLoaded());
+    }
+    SECTION("Pinned datasets are kept")
+    {
+        auto pin = iris.pin();
+        REQUIRE(iris.isLoaded());
+        REQUIRE_FALSE(glass.isLoaded());
+        glass.load();
+        ecoli.load();
+        REQUIRE(iris.isLoaded());
+        REQUIRE_FALSE(glass.isLoaded());
+        REQUIRE(ecoli.isLoaded());
+        REQUIRE(iris.getNSamples() == 150);
+        // Released with its pin
+        pin = platform::Dataset::Pin();
+        glass.load();
+        REQUIRE_FALSE(iris.isLoaded());
+        REQUIRE_FALSE(ecoli.isLoaded());
+        REQUIRE(glass.isLoaded());
+    }
+    SECTION("No limit")
+    {
+        platform::Dataset::setMemoryBudget(0);
+        iris.load();
+        glass.load();
+        ecoli.load();
+        REQUIRE(iris.isLoaded());
+        REQUIRE(glass.isLoaded());
+        REQUIRE(ecoli.isLoaded());
+    }
+    // Default budget of the shared catalogs
+    platform::Dataset::setMemoryBudget(static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE) / 4);
+}
+TEST_CASE("Dataset single copy of the data", "[Dataset]")
+{
+    DatasetFolder folder("iris", "class");
+    platform::Dataset::setCacheFolder("");
+    auto dataset = folder.dataset();
+    dataset.load();
+    auto [X, y] = dataset.getTensors();
+    auto [columns, labels] = dataset.getVectors();
+    REQUIRE(columns.size() == 4);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        REQUIRE(columns[i].data() == X.data_ptr<float>() + i * 150);
+    }
+    REQUIRE(labels.data() == y.data_ptr<int>());
+    SECTION("Copies share the data")
+    {
+        platform::Dataset copy(dataset);
+        REQUIRE(copy.isLoaded());
+        REQUIRE(copy.getTensors().first.data_ptr() == X.data_ptr());
+        REQUIRE(copy.getTensors().second.data_ptr() == y.data_ptr());
+        REQUIRE(copy.getVectors().first[0].data() == columns[0].data());
+    }
+    SECTION("Data mapped from the cache is private")
+    {
+        auto cached = folder.dataset();
+        cached.load();
+        auto original = cached.getTensors().first[0][0].item<float>();
+        cached.getTensors().first[0][0] = original + 100;
+        auto reloaded = folder.dataset();
+        reloaded.load();
+        REQUIRE(reloaded.getTensors().first[0][0].item<float>() == original);
+        REQUIRE(torch::equal(reloaded.getTensors().first, X));
+    }
+}
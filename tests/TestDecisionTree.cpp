@@ -8,8 +8,11 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <torch/torch.h>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 #include "experimental_clfs/DecisionTree.h"
 #include "TestUtils.h"
@@ -17,6 +20,101 @@
 using namespace bayesnet;
 using namespace Catch::Matchers;
 
+namespace {
+    // Baseline tree builder: the split finder masks the samples for every unique value of every feature.
+    // The class weights are summed in double from the float weights as the histogram finder does, so the
+    // sums are exact in both and ties are broken the same way. Nodes are stored in preorder
+    class MaskTree {
+    public:
+        MaskTree(int max_depth, int min_samples_split, int min_samples_leaf, int n_classes) :
+            max_depth(max_depth), min_samples_split(min_samples_split), min_samples_leaf(min_samples_leaf), n_classes(n_classes)
+        {
+        }
+        void build(const torch::Tensor& X, const torch::Tensor& y, const torch::Tensor& weights, int depth = 0)
+        {
+            int n_samples = y.size(0);
+            if (depth >= max_depth || n_samples < min_samples_split || n_samples <= min_samples_leaf
+                || std::get<0>(at::_unique(y)).size(0) == 1) {
+                leaf(y, weights);
+                return;
+            }
+            auto node_weights = classWeights(y, weights);
+            double current_impurity = gini(node_weights);
+            double total_weight = std::accumulate(node_weights.begin(), node_weights.end(), 0.0);
+            int best_feature = -1, best_value = -1;
+            double best_decrease = -std::numeric_limits<double>::infinity();
+            for (int feat_idx = 0; feat_idx < X.size(1); feat_idx++) {
+                auto column = X.index({ torch::indexing::Slice(), feat_idx });
+                auto unique_values = std::get<0>(torch::unique_consecutive(std::get<0>(torch::sort(column))));
+                for (int i = 0; i < unique_values.size(0); i++) {
+                    int split_value = unique_values[i].item<int>();
+                    auto left_mask = column == split_value;
+                    auto right_mask = ~left_mask;
+                    int left_count = left_mask.sum().item<int>();
+                    if (left_count < min_samples_leaf || n_samples - left_count < min_samples_leaf) {
+                        continue;
+                    }
+                    auto left = classWeights(y.index({ left_mask }), weights.index({ left_mask }));
+                    auto right = classWeights(y.index({ right_mask }), weights.index({ right_mask }));
+                    double left_weight = std::accumulate(left.begin(), left.end(), 0.0);
+                    double right_weight = std::accumulate(right.begin(), right.end(), 0.0);
+                    double decrease = current_impurity -
+                        (left_weight / total_weight * gini(left) + right_weight / total_weight * gini(right));
+                    if (decrease > best_decrease) {
+                        best_feature = feat_idx;
+                        best_value = split_value;
+                        best_decrease = decrease;
+                    }
+                }
+            }
+            if (best_feature == -1 || best_decrease <= 0) {
+                leaf(y, weights);
+                return;
+            }
+            feature.push_back(best_feature);
+            value.push_back(best_value);
+            probabilities.push_back({});
+            auto mask = X.index({ torch::indexing::Slice(), best_feature }) == best_value;
+            build(X.index({ mask }), y.index({ mask }), weights.index({ mask }), depth + 1);
+            build(X.index({ ~mask }), y.index({ ~mask }), weights.index({ ~mask }), depth + 1);
+        }
+        std::vector<int> feature, value;
+        std::vector<std::vector<float>> probabilities;
+    private:
+        std::vector<double> classWeights(const torch::Tensor& y, const torch::Tensor& weights) const
+        {
+            std::vector<double> result(n_classes, 0.0);
+            auto w = weights.to(torch::kFloat32);
+            for (int i = 0; i < y.size(0); i++) {
+                result[y[i].item<int>()] += w[i].item<float>();
+            }
+            return result;
+        }
+        double gini(const std::vector<double>& class_weights) const
+        {
+            double total = std::accumulate(class_weights.begin(), class_weights.end(), 0.0);
+            if (total == 0) return 0.0;
+            double result = 1.0;
+            for (auto weight : class_weights) {
+                result -= (weight / total) * (weight / total);
+            }
+            return result;
+        }
+        void leaf(const torch::Tensor& y, const torch::Tensor& weights)
+        {
+            auto probs = torch::zeros({ n_classes });
+            for (int i = 0; i < y.size(0); i++) {
+                probs[y[i].item<int>()] += weights[i].item<float>();
+            }
+            probs /= probs.sum();
+            feature.push_back(-1);
+            value.push_back(-1);
+            probabilities.emplace_back(probs.data_ptr<float>(), probs.data_ptr<float>() + n_classes);
+        }
+        int max_depth, min_samples_split, min_samples_leaf, n_classes;
+    };
+}
+
 TEST_CASE("DecisionTree Construction", "[DecisionTree]")
 {
     SECTION("Default constructor")
@@ -308,4 +406,34 @@ TEST_CASE("DecisionTree with Weights", "[DecisionTree]")
         auto predictions = dt.predict(raw.Xt);
         REQUIRE(predictions.size(0) == raw.yt.size(0));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("DecisionTree histogram splits match the mask based splits", "[DecisionTree]")
+{
+    auto file_name = GENERATE("iris", "glass");
+    auto weighted = GENERATE(false, true);
+    auto raw = RawDatasets(file_name, true);
+    auto weights = raw.weights.clone();
+    if (weighted) {
+        // Doubles the weight of one sample out of three
+        weights.index({ torch::indexing::Slice(0, torch::indexing::None, 3) }) *= 2.0;
+    }
+    int n_classes = raw.statest.at(raw.classNamet).size();
+    DecisionTree dt(5, 2, 1);
+    dt.fit(raw.dataset, raw.featurest, raw.classNamet, raw.statest, weights, Smoothing_t::NONE);
+    MaskTree reference(5, 2, 1, n_classes);
+    reference.build(raw.Xt.t(), raw.yt, weights / weights.sum());
+    INFO("Dataset " << file_name << " weighted " << weighted);
+    REQUIRE(dt.nodeCount() == static_cast<int>(reference.feature.size()));
+    for (int node = 0; node < dt.nodeCount(); node++) {
+        INFO("Node " << node);
+        REQUIRE(dt.splitFeature(node) == reference.feature[node]);
+        if (reference.feature[node] >= 0) {
+            REQUIRE(dt.splitValue(node) == reference.value[node]);
+            continue;
+        }
+        auto probabilities = dt.leafProbabilities(node);
+        for (int c = 0; c < n_classes; c++) {
+            REQUIRE(probabilities[c] == reference.probabilities[node][c]);
+        }
+    }
+}
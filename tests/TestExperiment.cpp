@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <string>
+#include <vector>
+#include "main/Experiment.h"
+#include "main/Models.h"
+#include "main/modelRegister.h"
+#include "common/Datasets.h"
+#include "common/DotEnv.h"
+#include "common/Paths.h"
+
+namespace {
+    platform::json run_experiment(const std::string& model, int jobs)
+    {
+        auto& datasets = platform::Datasets::shared(true, platform::Paths::datasets(), "mdlp");
+        platform::Experiment experiment;
+        experiment.setTitle("Jobs test").setLanguage("c++").setLanguageVersion("test");
+        experiment.setDiscretizationAlgorithm("mdlp").setSmoothSrategy("ORIGINAL");
+        experiment.setDiscretized(true).setModel(model).setPlatform("Test");
+        experiment.setStratified(true).setNFolds(5).setScoreName("accuracy");
+        experiment.setHyperparameters(platform::HyperParameters(datasets.getNames(), platform::json::object()));
+        experiment.addRandomSeed(271).addRandomSeed(314);
+        experiment.setFilesToTest({ "iris", "glass" });
+        experiment.setQuiet(true);
+        experiment.setJobs(jobs);
+        experiment.go();
+        return experiment.getResult().getJson();
+    }
+}
+
+TEST_CASE("Experiment with several jobs gives the results of one job", "[Experiment]")
+{
+    auto dotEnv = platform::DotEnv(true);
+    auto model = GENERATE("TAN", "XA1DE");
+    auto sequential = run_experiment(model, 1);
+    auto parallel = run_experiment(model, 4);
+    REQUIRE(sequential["results"].size() == parallel["results"].size());
+    for (size_t i = 0; i < sequential["results"].size(); ++i) {
+        const auto& expected = sequential["results"][i];
+        const auto& computed = parallel["results"][i];
+        INFO("Model " << model << " dataset " << expected["dataset"].get<std::string>());
+        REQUIRE(computed["dataset"] == expected["dataset"]);
+        // Folds in the same order (seed by seed), so the scores are the same lists
+        REQUIRE(computed["scores_test"] == expected["scores_test"]);
+        REQUIRE(computed["scores_train"] == expected["scores_train"]);
+        REQUIRE(computed["confusion_matrices"] == expected["confusion_matrices"]);
+        REQUIRE(computed["score"] == expected["score"]);
+        REQUIRE(computed["score_std"] == expected["score_std"]);
+        REQUIRE(computed["notes"] == expected["notes"]);
+    }
+}
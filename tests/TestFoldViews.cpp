@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <torch/torch.h>
+#include <folding.hpp>
+#include "common/FoldViews.hpp"
+#include "TestUtils.h"
+
+TEST_CASE("FoldViews match the fold copies", "[FoldViews]")
+{
+    auto file_name = GENERATE("iris", "glass", "diabetes");
+    auto stratified = GENERATE(true, false);
+    auto raw = RawDatasets(file_name, false);
+    int n_folds = 5;
+    int seed = 271;
+    folding::Fold* fold;
+    if (stratified)
+        fold = new folding::StratifiedKFold(n_folds, raw.yt, seed);
+    else
+        fold = new folding::KFold(n_folds, raw.nSamples, seed);
+    auto views = platform::FoldViews(*fold, n_folds, raw.Xt, raw.yt);
+    REQUIRE(views.size() == n_folds);
+    for (int k = 0; k < n_folds; ++k) {
+        INFO("Dataset " << file_name << " stratified " << stratified << " fold " << k);
+        auto [train, test] = fold->getFold(k);
+        auto train_t = torch::tensor(train);
+        auto test_t = torch::tensor(test);
+        auto [X_train, X_test, y_train, y_test] = views.getFold(k);
+        REQUIRE(torch::equal(X_train, raw.Xt.index_select(-1, train_t)));
+        REQUIRE(torch::equal(X_test, raw.Xt.index_select(-1, test_t)));
+        REQUIRE(torch::equal(y_train, raw.yt.index_select(0, train_t)));
+        REQUIRE(torch::equal(y_test, raw.yt.index_select(0, test_t)));
+    }
+    delete fold;
+}
@@ -1,9 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <filesystem>
 #include <vector>
 #include <string>
+#include <unistd.h>
 #include "TestUtils.h"
 #include "results/Result.h"
+#include "results/ResultsCatalog.h"
+#include "results/ResultFile.hpp"
 #include "common/DotEnv.h"
 #include "common/Datasets.h"
 #include "common/Paths.h"
@@ -23,4 +27,39 @@ TEST_CASE("ZeroR comparison in reports", "[Report]")
     std::vector<int>::iterator maxValue = max_element(distribution.begin(), distribution.end());
     double mark = *maxValue / nSamples * (1 + margin);
     REQUIRE(mark == Catch::Approx(0.57976811f).epsilon(margin));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Saving a catalog result keeps the whole file", "[Result]")
+{
+    auto dotEnv = platform::DotEnv(true);
+    auto folder = std::filesystem::temp_directory_path() / ("platform_test_results_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    auto path = folder.string() + "/";
+    platform::json data = {
+        { "date", "2024-01-01" }, { "time", "10:00:00" }, { "title", "Original title" }, { "model", "TAN" },
+        { "version", "1.0.0" }, { "platform", "Test" }, { "score_name", "accuracy" }, { "stratified", true },
+        { "folds", 5 }, { "seeds", { 271 } }, { "duration", 1.5 }, { "discretized", true },
+        { "results", {
+            {
+                { "dataset", "iris" }, { "score", 0.9 }, { "score_std", 0.01 }, { "hyperparameters", platform::json::object() },
+                { "scores_test", { 0.9, 0.8, 1.0, 0.9, 0.9 } }, { "times_train", { 0.1, 0.2, 0.1, 0.2, 0.1 } },
+                { "confusion_matrices", { { { 10, 0 }, { 1, 9 } } } }, { "notes", { "a note" } }
+            }
+        } }
+    };
+    platform::ResultFile::write(path + "results_accuracy_TAN_Test_2024-01-01_10:00:00_1.json", data);
+    auto results = platform::ResultsCatalog(path).load();
+    REQUIRE(results.size() == 1);
+    auto& result = results.at(0);
+    REQUIRE(result.isSummary());
+    REQUIRE(!result.getData()["results"][0].contains("confusion_matrices"));
+    result.setTitle("New title");
+    result.save(path);
+    REQUIRE(!result.isSummary());
+    auto saved = platform::Result(path, result.getFilename()).getJson();
+    auto expected = data;
+    expected["title"] = "New title";
+    REQUIRE(saved == expected);
+    std::filesystem::remove_all(folder);
+}
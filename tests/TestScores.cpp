@@ -9,6 +9,7 @@
 #include "common/Paths.h"
 #include "common/Colors.h"
 #include "main/Scores.h"
+#include "main/RocAuc.h"
 #include "config_platform.h"
 
 using json = nlohmann::ordered_json;
@@ -302,4 +303,23 @@ TEST_CASE("Order of keys", "[Scores]")
         REQUIRE(scores.precision(i) == scores2.precision(i));
         REQUIRE(scores.recall(i) == scores2.recall(i));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("AUC with tied scores", "[Scores]")
+{
+    // Binary problem scored with class 0: positives 0.9, 0.5 against negatives 0.5, 0.1
+    // gives 3 correctly ordered pairs and one tie out of 4
+    std::vector<int> y_test = { 0, 0, 1, 1 };
+    std::vector<std::vector<double>> probs = { { 0.9, 0.1 }, { 0.5, 0.5 }, { 0.5, 0.5 }, { 0.1, 0.9 } };
+    auto y_test_tensor = torch::tensor(y_test, torch::kInt32);
+    auto y_pred = torch::tensor({ 0.9, 0.1, 0.5, 0.5, 0.5, 0.5, 0.1, 0.9 }, torch::kFloat64).view({ 4, 2 });
+    platform::Scores scores(y_test_tensor, y_pred, 2);
+    REQUIRE(scores.auc() == Catch::Approx(0.875));
+    platform::RocAuc roc_auc;
+    REQUIRE(roc_auc.compute(probs, y_test) == Catch::Approx(0.875));
+    REQUIRE(roc_auc.compute(y_pred, y_test_tensor) == Catch::Approx(0.875));
+    // Constant scores can't rank the classes
+    auto y_flat = torch::full({ 4, 2 }, 0.5, torch::kFloat64);
+    platform::Scores scores_flat(y_test_tensor, y_flat, 2);
+    REQUIRE(scores_flat.auc() == Catch::Approx(0.5));
+}
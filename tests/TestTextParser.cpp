@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/TextParser.hpp"
+
+using namespace Catch::Matchers;
+
+namespace {
+    struct Parsed {
+        std::vector<std::vector<float>> X;
+        std::vector<int> y;
+        std::vector<std::string> labels;
+    };
+    Parsed parse(const std::string& text, platform::TextParser::Format format, const std::vector<bool>& categorical)
+    {
+        Parsed parsed;
+        auto parser = platform::TextParser(text.data(), text.size(), format);
+        parser.parse(categorical, parsed.X, parsed.y, parsed.labels);
+        return parsed;
+    }
+}
+
+TEST_CASE("TextParser skips the invalid csv_json rows", "[TextParser]")
+{
+    // Categorical color, numeric size and a text label as the csv_json datasets
+    std::string text =
+        "color,size,class\n"
+        "red,1.5,yes\n"
+        "blue,,no\n"          // missing number
+        "green,abc,no\n"      // non numeric value
+        "blue,2.5,no\n"
+        "red,3.5\n"           // missing column
+        ",4.5,yes\n"          // missing category
+        "red,1,yes,extra\n"   // extra column
+        "white,5,maybe\n";
+    auto format = platform::TextParser::Format{ ',', false, true, false };
+    for (size_t blocks : { 1, 3 }) {
+        INFO("Blocks " << blocks);
+        format.blocks = blocks;
+        auto parsed = parse(text, format, { true, false });
+        // green is only in a skipped row so it gets no code
+        REQUIRE(parsed.X == std::vector<std::vector<float>>{ { 0, 1, 2 }, { 1.5, 2.5, 5 } });
+        REQUIRE(parsed.y == std::vector<int>{ 0, 1, 2 });
+        REQUIRE(parsed.labels == std::vector<std::string>{ "yes", "no", "maybe" });
+    }
+}
+TEST_CASE("TextParser throws on invalid csv values", "[TextParser]")
+{
+    auto format = platform::TextParser::Format{ ',' };
+    std::vector<bool> categorical = { false, false };
+    REQUIRE_THROWS_WITH(parse("a,b,class\n1,2,0\n1,x,1\n", format, categorical), "Invalid value: x in line 3");
+    REQUIRE_THROWS_AS(parse("a,b,class\n1,,0\n", format, categorical), std::invalid_argument);
+    REQUIRE_THROWS_WITH(parse("a,b,class\n1,2,0\n3,4,0\n5,6\n", format, categorical), "Wrong number of columns in line 4");
+    REQUIRE_THROWS_WITH(parse("a,b,class\n1,2,yes\n", format, categorical), "Invalid label: yes in line 2");
+    format.blocks = 3;
+    REQUIRE_THROWS_WITH(parse("a,b,class\n1,2,0\n3,4,0\n5,6,1\n7,x,1\n", format, categorical), "Invalid value: x in line 5");
+}
+TEST_CASE("TextParser factorization is the same across blocks", "[TextParser]")
+{
+    // New values keep appearing all along the file, so each block sees a different subset first
+    std::string text = "f1,f2,class\n";
+    std::vector<std::vector<float>> expected_X(2);
+    std::vector<int> expected_y;
+    std::vector<std::string> expected_labels;
+    std::unordered_map<std::string, int> codes_f1, labels;
+    for (int i = 0; i < 500; ++i) {
+        auto f1 = "v" + std::to_string((i * 7919) % (i / 10 + 1));
+        auto label = "c" + std::to_string((i * 31) % (i / 50 + 1));
+        text += f1 + "," + std::to_string(i % 13) + "," + label + "\n";
+        auto code = codes_f1.try_emplace(f1, static_cast<int>(codes_f1.size())).first->second;
+        auto [item, inserted] = labels.try_emplace(label, static_cast<int>(labels.size()));
+        if (inserted)
+            expected_labels.push_back(label);
+        expected_X[0].push_back(static_cast<float>(code));
+        expected_X[1].push_back(static_cast<float>(i % 13));
+        expected_y.push_back(item->second);
+    }
+    auto format = platform::TextParser::Format{ ',', false, true, false };
+    for (size_t blocks : { 1, 2, 3, 7, 16 }) {
+        INFO("Blocks " << blocks);
+        format.blocks = blocks;
+        auto parsed = parse(text, format, { true, false });
+        REQUIRE(parsed.X == expected_X);
+        REQUIRE(parsed.y == expected_y);
+        REQUIRE(parsed.labels == expected_labels);
+    }
+}
+TEST_CASE("TextParser line endings", "[TextParser]")
+{
+    std::vector<bool> categorical = { false, false };
+    auto expected_X = std::vector<std::vector<float>>{ { 1, 3, 5 }, { 2, 4, 6 } };
+    auto expected_y = std::vector<int>{ 0, 1, 0 };
+    auto format = platform::TextParser::Format{ ',' };
+    SECTION("Last line without newline")
+    {
+        for (size_t blocks : { 1, 2, 3 }) {
+            INFO("Blocks " << blocks);
+            format.blocks = blocks;
+            auto parsed = parse("a,b,class\n1,2,0\n3,4,1\n5,6,0", format, categorical);
+            REQUIRE(parsed.X == expected_X);
+            REQUIRE(parsed.y == expected_y);
+        }
+    }
+    SECTION("CRLF line endings")
+    {
+        std::string text = "a,b,class\r\n1,2,0\r\n3,4,1\r\n5,6,0\r\n\r\n";
+        auto parser = platform::TextParser(text.data(), text.size(), format);
+        REQUIRE(parser.header() == std::vector<std::string>{ "a", "b", "class" });
+        for (size_t blocks : { 1, 2, 3 }) {
+            INFO("Blocks " << blocks);
+            format.blocks = blocks;
+            auto parsed = parse(text, format, categorical);
+            REQUIRE(parsed.X == expected_X);
+            REQUIRE(parsed.y == expected_y);
+            auto last = parse("a,b,class\r\n1,2,0\r\n3,4,1\r\n5,6,0", format, categorical);
+            REQUIRE(last.X == expected_X);
+            REQUIRE(last.y == expected_y);
+        }
+    }
+}
@@ -0,0 +1,251 @@
+// ***************************************************************
+// SPDX-FileCopyrightText: Copyright 2025 Ricardo Montañana Gómez
+// SPDX-FileType: SOURCE
+// SPDX-License-Identifier: MIT
+// ***************************************************************
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <random>
+#include <torch/torch.h>
+#include "experimental_clfs/Xaode.hpp"
+#include "experimental_clfs/XA1DE.h"
+#include "TestUtils.h"
+
+using namespace platform;
+
+namespace {
+    std::vector<std::vector<double>> fit_predict(RawDatasets& raw, Xaode::TableMode mode)
+    {
+        Xaode aode;
+        aode.setTableMode(mode);
+        auto weights = torch::full({ raw.nSamples }, 1.0, torch::kDouble);
+        aode.fit(raw.Xv, raw.yv, raw.featuresv, raw.classNamev, raw.statesv, weights, true, bayesnet::Smoothing_t::ORIGINAL);
+        std::vector<std::vector<double>> probs(raw.nSamples);
+        aode.predict_proba_batch(raw.Xv, 0, raw.nSamples, probs);
+        return probs;
+    }
+    int argmax(const std::vector<double>& values)
+    {
+        return std::distance(values.begin(), std::max_element(values.begin(), values.end()));
+    }
+}
+
+TEST_CASE("Xaode table modes equivalence", "[Xaode]")
+{
+    auto file_name = GENERATE("iris", "ecoli", "glass", "diabetes");
+    auto raw = RawDatasets(file_name, true);
+    auto expected = fit_predict(raw, Xaode::TableMode::PROBS);
+    SECTION("Log-space float64")
+    {
+        auto computed = fit_predict(raw, Xaode::TableMode::LOG64);
+        for (int i = 0; i < raw.nSamples; ++i) {
+            REQUIRE(argmax(computed[i]) == argmax(expected[i]));
+            for (int c = 0; c < expected[i].size(); ++c) {
+                REQUIRE(computed[i][c] == Catch::Approx(expected[i][c]).margin(1e-9));
+            }
+        }
+    }
+    SECTION("Log-space float32")
+    {
+        auto computed = fit_predict(raw, Xaode::TableMode::LOG32);
+        int correct_expected = 0, correct_computed = 0;
+        for (int i = 0; i < raw.nSamples; ++i) {
+            correct_expected += argmax(expected[i]) == raw.yv[i];
+            correct_computed += argmax(computed[i]) == raw.yv[i];
+            for (int c = 0; c < expected[i].size(); ++c) {
+                REQUIRE(computed[i][c] == Catch::Approx(expected[i][c]).margin(1e-4));
+            }
+        }
+        REQUIRE(correct_computed == correct_expected);
+    }
+}
+TEST_CASE("Xaode batch and per instance predictions", "[Xaode]")
+{
+    auto file_name = GENERATE("iris", "ecoli", "glass", "diabetes");
+    auto raw = RawDatasets(file_name, true);
+    Xaode aode;
+    auto weights = torch::full({ raw.nSamples }, 1.0, torch::kDouble);
+    aode.fit(raw.Xv, raw.yv, raw.featuresv, raw.classNamev, raw.statesv, weights, true, bayesnet::Smoothing_t::ORIGINAL);
+    REQUIRE(aode.state() == Xaode::MatrixState::PROBS);
+    std::vector<std::vector<double>> batch(raw.nSamples);
+    aode.predict_proba_batch(raw.Xv, 0, raw.nSamples, batch);
+    std::vector<int> instance(raw.Xv.size());
+    for (int i = 0; i < raw.nSamples; ++i) {
+        for (int f = 0; f < raw.Xv.size(); ++f) {
+            instance[f] = raw.Xv[f][i];
+        }
+        REQUIRE(aode.predict_proba(instance) == batch[i]);
+    }
+}
+TEST_CASE("Xaode parallel counts", "[Xaode]")
+{
+    //
+    // The counts split among the pool workers are the ones of adding the samples one by one: on a test
+    // dataset with the threshold lowered to 0, and on a synthetic dataset above the default threshold
+    //
+    std::vector<std::vector<int>> X;
+    std::vector<int> y;
+    double threshold;
+    SECTION("Test dataset")
+    {
+        auto raw = RawDatasets("glass", true);
+        X = raw.Xv;
+        y = raw.yv;
+        threshold = 0.0;
+    }
+    SECTION("Synthetic dataset")
+    {
+        const int n_samples = 3000, n_features = 30;
+        std::mt19937 generator(271);
+        X = std::vector<std::vector<int>>(n_features, std::vector<int>(n_samples));
+        y = std::vector<int>(n_samples);
+        for (int i = 0; i < n_samples; ++i) {
+            for (int f = 0; f < n_features; ++f) {
+                X[f][i] = generator() % (2 + f % 5);
+            }
+            y[i] = generator() % 3;
+        }
+        threshold = 1e6;
+        REQUIRE(static_cast<double>(n_samples) * n_features * n_features / 2 >= threshold);
+    }
+    Xaode parallel;
+    parallel.setParallelCountThreshold(threshold);
+    parallel.fitCounts(X, y, true);
+    Xaode sequential;
+    sequential.initializeCounts(X, y, true);
+    std::vector<int> instance(X.size() + 1);
+    for (int i = 0; i < y.size(); ++i) {
+        for (int f = 0; f < X.size(); ++f) {
+            instance[f] = X[f][i];
+        }
+        instance.back() = y[i];
+        sequential.addSample(instance, 1.0);
+    }
+    REQUIRE(parallel.state() == Xaode::MatrixState::COUNTS);
+    // Unit weights, the counts are integers and printed exactly
+    REQUIRE(parallel.to_string() == sequential.to_string());
+}
+TEST_CASE("Xaode table mode set after fit", "[Xaode]")
+{
+    auto raw = RawDatasets("iris", true);
+    Xaode aode;
+    auto weights = torch::full({ raw.nSamples }, 1.0, torch::kDouble);
+    aode.fit(raw.Xv, raw.yv, raw.featuresv, raw.classNamev, raw.statesv, weights, true, bayesnet::Smoothing_t::ORIGINAL);
+    REQUIRE_THROWS_AS(aode.setTableMode(Xaode::TableMode::LOG32), std::logic_error);
+}
+TEST_CASE("Xaode fit by count subtraction", "[Xaode]")
+{
+    auto file_name = GENERATE("iris", "ecoli", "glass", "diabetes");
+    auto raw = RawDatasets(file_name, true);
+    auto smoothing = GENERATE(bayesnet::Smoothing_t::ORIGINAL, bayesnet::Smoothing_t::LAPLACE);
+    Xaode total;
+    total.fitCounts(raw.Xv, raw.yv, true);
+    REQUIRE(total.state() == Xaode::MatrixState::COUNTS);
+    //
+    // Every fifth sample is a test sample, except the ones with the last state of a feature or the
+    // last class, so the train samples keep the states of the dataset and the subtraction is accepted
+    //
+    int n_features = raw.Xv.size();
+    std::vector<int> last_states(n_features);
+    for (int f = 0; f < n_features; ++f) {
+        last_states[f] = *std::max_element(raw.Xv[f].begin(), raw.Xv[f].end());
+    }
+    int last_class = *std::max_element(raw.yv.begin(), raw.yv.end());
+    std::vector<std::vector<int>> X_train(n_features), X_test(n_features);
+    std::vector<int> y_train, y_test;
+    for (int i = 0; i < raw.nSamples; ++i) {
+        bool keeps_state = raw.yv[i] == last_class;
+        for (int f = 0; f < n_features; ++f) {
+            keeps_state = keeps_state || raw.Xv[f][i] == last_states[f];
+        }
+        bool test = i % 5 == 0 && !keeps_state;
+        auto& X_target = test ? X_test : X_train;
+        for (int f = 0; f < n_features; ++f) {
+            X_target[f].push_back(raw.Xv[f][i]);
+        }
+        (test ? y_test : y_train).push_back(raw.yv[i]);
+    }
+    REQUIRE(!y_test.empty());
+    Xaode expected;
+    auto weights = torch::full({ static_cast<int64_t>(y_train.size()) }, 1.0, torch::kDouble);
+    expected.fit(X_train, y_train, raw.featuresv, raw.classNamev, raw.statesv, weights, true, smoothing);
+    Xaode computed;
+    REQUIRE(computed.fitSubtracting(total, X_test, y_test, smoothing));
+    REQUIRE(computed.state() == Xaode::MatrixState::PROBS);
+    std::vector<std::vector<double>> probs_expected(raw.nSamples), probs_computed(raw.nSamples);
+    expected.predict_proba_batch(raw.Xv, 0, raw.nSamples, probs_expected);
+    computed.predict_proba_batch(raw.Xv, 0, raw.nSamples, probs_computed);
+    for (int i = 0; i < raw.nSamples; ++i) {
+        REQUIRE(probs_computed[i] == probs_expected[i]);
+    }
+}
+TEST_CASE("Xaode count subtraction losing a state", "[Xaode]")
+{
+    auto raw = RawDatasets("iris", true);
+    Xaode total;
+    total.fitCounts(raw.Xv, raw.yv, true);
+    // The test samples are the ones with the last state of the first feature
+    int last = *std::max_element(raw.Xv[0].begin(), raw.Xv[0].end());
+    std::vector<std::vector<int>> X_test(raw.Xv.size());
+    std::vector<int> y_test;
+    for (int i = 0; i < raw.nSamples; ++i) {
+        if (raw.Xv[0][i] != last)
+            continue;
+        for (int f = 0; f < raw.Xv.size(); ++f) {
+            X_test[f].push_back(raw.Xv[f][i]);
+        }
+        y_test.push_back(raw.yv[i]);
+    }
+    Xaode computed;
+    REQUIRE_FALSE(computed.fitSubtracting(total, X_test, y_test, bayesnet::Smoothing_t::ORIGINAL));
+    REQUIRE(computed.state() == Xaode::MatrixState::EMPTY);
+    Xaode fitted;
+    auto weights = torch::full({ raw.nSamples }, 1.0, torch::kDouble);
+    fitted.fit(raw.Xv, raw.yv, raw.featuresv, raw.classNamev, raw.statesv, weights, true, bayesnet::Smoothing_t::ORIGINAL);
+    REQUIRE_THROWS_AS(computed.fitSubtracting(fitted, X_test, y_test, bayesnet::Smoothing_t::ORIGINAL), std::logic_error);
+}
+TEST_CASE("XA1DE count subtraction fits as fit", "[Xaode]")
+{
+    auto raw = RawDatasets("iris", true);
+    auto lose_state = GENERATE(false, true);
+    //
+    // Every fifth sample is a test sample, except the ones with the last state of a feature or the last
+    // class. Otherwise the test samples are the ones with the last state of the first feature, which the
+    // train samples lose, so the counts can't be subtracted and the fold is fitted from its train samples
+    //
+    int n_features = raw.Xv.size();
+    std::vector<int> last_states(n_features);
+    for (int f = 0; f < n_features; ++f) {
+        last_states[f] = *std::max_element(raw.Xv[f].begin(), raw.Xv[f].end());
+    }
+    int last_class = *std::max_element(raw.yv.begin(), raw.yv.end());
+    std::vector<int> train, test;
+    for (int i = 0; i < raw.nSamples; ++i) {
+        bool keeps_state = raw.yv[i] == last_class;
+        for (int f = 0; f < n_features; ++f) {
+            keeps_state = keeps_state || raw.Xv[f][i] == last_states[f];
+        }
+        bool is_test = lose_state ? raw.Xv[0][i] == last_states[0] : i % 5 == 0 && !keeps_state;
+        (is_test ? test : train).push_back(i);
+    }
+    auto train_t = torch::tensor(train);
+    auto test_t = torch::tensor(test);
+    auto X_train = raw.Xt.index({ "...", train_t });
+    auto y_train = raw.yt.index({ train_t });
+    auto X_test = raw.Xt.index({ "...", test_t });
+    auto y_test = raw.yt.index({ test_t });
+    auto total = XA1DE::countTotal(raw.Xt, raw.yt);
+    XA1DE expected, computed;
+    expected.fit(X_train, y_train, raw.featurest, raw.classNamet, raw.statest, bayesnet::Smoothing_t::ORIGINAL);
+    REQUIRE(computed.fitSubtracting(*total, X_train, y_train, X_test, y_test, raw.featurest, raw.classNamet, raw.statest, bayesnet::Smoothing_t::ORIGINAL) == !lose_state);
+    REQUIRE(computed.getStatus() == expected.getStatus());
+    REQUIRE(computed.getNotes() == expected.getNotes());
+    REQUIRE(computed.getNumberOfNodes() == expected.getNumberOfNodes());
+    REQUIRE(computed.getNumberOfEdges() == expected.getNumberOfEdges());
+    REQUIRE(computed.getNumberOfStates() == expected.getNumberOfStates());
+    REQUIRE(computed.getClassNumStates() == expected.getClassNumStates());
+    REQUIRE(torch::equal(computed.predict_proba(raw.Xt), expected.predict_proba(raw.Xt)));
+    REQUIRE(computed.score(raw.Xt, raw.yt) == expected.score(raw.Xt, raw.yt));
+}